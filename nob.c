@@ -6,6 +6,27 @@
 #define SRC_FOLDER "src/"
 #define BUILD_FOLDER "build/"
 
+static const char *objects[] = {
+    "accumulator",
+    "archetype",
+    "batch",
+    "bench",
+    "bench_collision",
+    "collision",
+    "frame_graph",
+    "game",
+    "headless",
+    "render_list",
+    "replay",
+    "rewind",
+    "rng",
+    "slot_map",
+    "sprite_batch",
+    "thread_pool",
+    "timer_wheel",
+    "triple_buffer",
+};
+
 int main(int argc, char **argv)
 {
     NOB_GO_REBUILD_URSELF(argc, argv);
@@ -16,24 +37,34 @@ int main(int argc, char **argv)
     }
 
     Cmd cmd = {0};
-    cmd_append(&cmd, "cc", "-fdiagnostics-color=always", "-Wall", "-Wextra");
-    cmd_append(&cmd, "-g");
-    cmd_append(&cmd, "-O", "-c", SRC_FOLDER "accumulator.c");
-    cmd_append(&cmd, "-o", BUILD_FOLDER "accumulator.o");
-    if (!cmd_run(&cmd))
+    for (size_t i = 0; i < ARRAY_LEN(objects); ++i)
     {
-        return 1;
+        cmd_append(&cmd, "cc", "-fdiagnostics-color=always", "-Wall", "-Wextra");
+        cmd_append(&cmd, "-g", "-pthread");
+        cmd_append(&cmd, "-O", "-c", temp_sprintf(SRC_FOLDER "%s.c", objects[i]));
+        cmd_append(&cmd, "-o", temp_sprintf(BUILD_FOLDER "%s.o", objects[i]));
+        cmd_append(&cmd, "-I./libs/raylib-5.5_linux_amd64/include/");
+        cmd_append(&cmd, "-I./" SRC_FOLDER);
+        cmd_append(&cmd, "-I.");
+        if (!cmd_run(&cmd))
+        {
+            return 1;
+        }
     }
 
     cmd_append(&cmd, "cc", "-fdiagnostics-color=always", "-Wall", "-Wextra");
     cmd_append(&cmd, "-g");
-    cmd_append(&cmd, "-o", "main", SRC_FOLDER "main.c", BUILD_FOLDER "accumulator.o");
+    cmd_append(&cmd, "-o", "main", SRC_FOLDER "main.c");
+    for (size_t i = 0; i < ARRAY_LEN(objects); ++i)
+    {
+        cmd_append(&cmd, temp_sprintf(BUILD_FOLDER "%s.o", objects[i]));
+    }
     cmd_append(&cmd, "-I./libs/raylib-5.5_linux_amd64/include/");
     cmd_append(&cmd, "-I./" SRC_FOLDER);
     cmd_append(&cmd, "-I.");
     cmd_append(&cmd, "-L./libs/raylib-5.5_linux_amd64/lib/");
     cmd_append(&cmd, "-l:libraylib.a");
-    cmd_append(&cmd, "-lm");
+    cmd_append(&cmd, "-lm", "-pthread");
     if (!cmd_run(&cmd))
     {
         return 1;
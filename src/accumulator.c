@@ -1,22 +1,35 @@
 #include "accumulator.h"
 
-bool accumulator_tick(Accumulator *accumulator, float dt, TickEndBehaviour when_tick_ends)
+uint64_t accumulator_ns(float seconds)
 {
-    if (accumulator->ms_accumulated > accumulator->ms_to_trigger)
+    return seconds > 0 ? (uint64_t)((double)seconds * 1e9 + 0.5) : 0;
+}
+
+bool accumulator_tick(Accumulator *accumulator, uint64_t dt_ns, TickEndBehaviour when_tick_ends)
+{
+    accumulator->ns_accumulated += dt_ns;
+    if (accumulator->ns_accumulated < accumulator->ns_to_trigger)
     {
-        if (when_tick_ends == When_Tick_Ends_Restart)
-        {
-            accumulator->ms_accumulated = 0;
-        }
-        return true;
+        return false;
     }
 
-    float add = dt * 1000.0;
-    accumulator->ms_accumulated += add;
-    return false;
+    if (when_tick_ends == When_Tick_Ends_Restart)
+    {
+        // A period of 0 triggers on every tick.
+        accumulator->ns_accumulated -= accumulator->ns_to_trigger > 0 ? accumulator->ns_to_trigger
+                                                                       : accumulator->ns_accumulated;
+    }
+    return true;
 }
 
-void accumulator_reset(Accumulator *accumulator)
+size_t accumulator_tick_all(Accumulator *accumulators, size_t count, uint64_t dt_ns, TickEndBehaviour when_tick_ends,
+                            bool *fired)
 {
-    accumulator->ms_accumulated = 0;
+    size_t fired_count = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        fired[i] = accumulator_tick(&accumulators[i], dt_ns, when_tick_ends);
+        fired_count += fired[i];
+    }
+    return fired_count;
 }
@@ -1,17 +1,29 @@
+#pragma once
+
 #include "stdbool.h"
+#include "stddef.h"
 #include "stdint.h"
 
+#define ACCUMULATOR_NS_PER_MS 1000000ull
+
 typedef enum
 {
     When_Tick_Ends_Restart = 1,
     When_Tick_Ends_Keep = 0,
 } TickEndBehaviour;
 
+// Counts whole nanoseconds, so short ticks still add up and 64 bits never overflow in practice. A restarting
+// accumulator keeps what it overshot by, so its n-th trigger is on the first tick that ends at or after n periods,
+// whatever the tick length.
 typedef struct
 {
-    uint16_t ms_to_trigger;
-    uint16_t ms_accumulated;
+    uint64_t ns_to_trigger;
+    uint64_t ns_accumulated;
 } Accumulator;
 
-bool accumulator_tick(Accumulator *, float dt, TickEndBehaviour);
-void accumulator_reset(Accumulator *);
+uint64_t accumulator_ns(float seconds);
+// Adds `dt_ns` and tells whether a whole period has gone by.
+bool accumulator_tick(Accumulator *, uint64_t dt_ns, TickEndBehaviour);
+// Ticks every accumulator of an array by the same `dt_ns`, setting `fired[i]` for each one that triggered. Returns how
+// many did.
+size_t accumulator_tick_all(Accumulator *, size_t count, uint64_t dt_ns, TickEndBehaviour, bool *fired);
@@ -0,0 +1,205 @@
+#include "archetype.h"
+
+#include "assert.h"
+#include "string.h"
+
+static size_t align_up(size_t value)
+{
+    return (value + ARCHETYPE_ALIGN - 1) / ARCHETYPE_ALIGN * ARCHETYPE_ALIGN;
+}
+
+void world_init(World *world, const uint16_t *component_sizes, size_t components_count)
+{
+    assert(components_count <= ARCHETYPE_MAX_COMPONENTS);
+    memset(world, 0, sizeof(*world));
+    memcpy(world->component_size, component_sizes, components_count * sizeof(*component_sizes));
+    world->components_count = components_count;
+    slot_map_init(&world->map, world->slots, WORLD_MAX_ENTITIES);
+}
+
+size_t world_add_table(World *world, ComponentMask components, size_t capacity)
+{
+    assert(world->tables_count < WORLD_MAX_TABLES && capacity > 0);
+    Archetype *table = &world->tables[world->tables_count];
+    table->components = components;
+    table->chunk_rows = capacity < ARCHETYPE_CHUNK_ROWS ? capacity : ARCHETYPE_CHUNK_ROWS;
+    size_t chunks = (capacity + table->chunk_rows - 1) / table->chunk_rows;
+    table->capacity = chunks * table->chunk_rows;
+
+    size_t offset = 0;
+    for (size_t component = 0; component < world->components_count; ++component)
+    {
+        if (components & (1u << component))
+        {
+            table->column[component] = offset;
+            offset = align_up(offset + table->chunk_rows * world->component_size[component]);
+        }
+    }
+    table->chunk_bytes = offset;
+    table->storage = world->storage_used;
+    table->first_owner = world->owners_used;
+    world->storage_used += chunks * table->chunk_bytes;
+    world->owners_used += table->capacity;
+    assert(world->storage_used <= WORLD_STORAGE_BYTES && world->owners_used <= WORLD_MAX_ENTITIES);
+
+    return world->tables_count++;
+}
+
+size_t world_spawn(World *world, size_t table, size_t count, Handle *handles)
+{
+    Archetype *archetype = &world->tables[table];
+    uint16_t *owners = &world->owners[archetype->first_owner];
+    size_t spawned = 0;
+    while (spawned < count && archetype->count < archetype->capacity)
+    {
+        Handle handle = slot_map_insert(&world->map, world->slots, owners, archetype->count);
+        if (handle == HANDLE_NONE)
+        {
+            break;
+        }
+        world->table_of[owners[archetype->count]] = table;
+        archetype->count += 1;
+        if (handles != NULL)
+        {
+            handles[spawned] = handle;
+        }
+        spawned += 1;
+    }
+
+    world->live += spawned;
+    if (world->live > world->high_water)
+    {
+        world->high_water = world->live;
+    }
+    if (archetype->count > archetype->high_water)
+    {
+        archetype->high_water = archetype->count;
+    }
+    return spawned;
+}
+
+bool world_find(const World *world, Handle handle, size_t *table, size_t *row)
+{
+    size_t index = 0;
+    if (!slot_map_find(&world->map, world->slots, handle, &index))
+    {
+        return false;
+    }
+
+    // A forged handle may carry the generation of a free slot, whose index is the next free slot instead of a row.
+    uint16_t slot = handle & 0xFFFF;
+    const Archetype *archetype = &world->tables[world->table_of[slot]];
+    if (index >= archetype->count || world->owners[archetype->first_owner + index] != slot)
+    {
+        return false;
+    }
+    *table = world->table_of[slot];
+    *row = index;
+    return true;
+}
+
+bool world_find_in(const World *world, Handle handle, size_t table, size_t *row)
+{
+    size_t found = 0;
+    return world_find(world, handle, &found, row) && found == table;
+}
+
+Handle world_handle(const World *world, size_t table, size_t row)
+{
+    return slot_map_handle(world->slots, &world->owners[world->tables[table].first_owner], row);
+}
+
+void world_despawn_row(World *world, size_t table, size_t row)
+{
+    Archetype *archetype = &world->tables[table];
+    size_t last = --archetype->count;
+    slot_map_remove(&world->map, world->slots, &world->owners[archetype->first_owner], row, last);
+    world->live -= 1;
+    if (row == last)
+    {
+        return;
+    }
+
+    for (size_t component = 0; component < world->components_count; ++component)
+    {
+        if (archetype->components & (1u << component))
+        {
+            memcpy(world_get(world, table, component, row), world_get(world, table, component, last),
+                   world->component_size[component]);
+        }
+    }
+}
+
+bool world_despawn(World *world, Handle handle)
+{
+    size_t table = 0;
+    size_t row = 0;
+    if (!world_find(world, handle, &table, &row))
+    {
+        return false;
+    }
+    world_despawn_row(world, table, row);
+    return true;
+}
+
+// From the last row, so none has to move.
+void world_clear(World *world, size_t table)
+{
+    while (world->tables[table].count > 0)
+    {
+        world_despawn_row(world, table, world->tables[table].count - 1);
+    }
+}
+
+Handle world_replace_row(World *world, size_t table, size_t row)
+{
+    uint16_t *owners = &world->owners[world->tables[table].first_owner];
+    slot_map_remove(&world->map, world->slots, owners, row, row);
+    // The slot just freed heads the free list, so this takes it back under its next generation.
+    Handle handle = slot_map_insert(&world->map, world->slots, owners, row);
+    world->table_of[owners[row]] = table;
+    return handle;
+}
+
+// Swaps two rows of every column along with their slots.
+static void swap_rows(World *world, size_t table, size_t a, size_t b)
+{
+    Archetype *archetype = &world->tables[table];
+    for (ComponentMask components = archetype->components; components != 0; components &= components - 1)
+    {
+        size_t component = __builtin_ctz(components);
+        uint8_t *x = world_get(world, table, component, a);
+        uint8_t *y = world_get(world, table, component, b);
+        for (size_t i = 0; i < world->component_size[component]; ++i)
+        {
+            uint8_t byte = x[i];
+            x[i] = y[i];
+            y[i] = byte;
+        }
+    }
+
+    uint16_t *owners = &world->owners[archetype->first_owner];
+    uint16_t owner = owners[a];
+    owners[a] = owners[b];
+    owners[b] = owner;
+    world->slots[owners[a]].index = a;
+    world->slots[owners[b]].index = b;
+}
+
+static void reverse_rows(World *world, size_t table, size_t first, size_t end)
+{
+    while (first + 1 < end)
+    {
+        swap_rows(world, table, first++, --end);
+    }
+}
+
+// Three reversals, which move every row at most twice and need no room besides.
+void world_rotate(World *world, size_t table, size_t first)
+{
+    size_t count = world->tables[table].count;
+    assert(first <= count);
+    reverse_rows(world, table, 0, first);
+    reverse_rows(world, table, first, count);
+    reverse_rows(world, table, 0, count);
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include "assert.h"
+#include "slot_map.h"
+#include "stdbool.h"
+#include "stddef.h"
+#include "stdint.h"
+
+// Entities stored by archetype: every entity with the same set of components is a row of the same table, and a table
+// keeps a column per component, so a system streams only the columns it uses and never skips holes. Rows are stored in
+// chunks of up to ARCHETYPE_CHUNK_ROWS, each chunk holding that many rows of every column, and queries hand out a
+// chunk at a time.
+//
+// Entities are named by handles from one slot map for the whole world. Despawning moves the last row of the table into
+// the hole, and the handle of the moved entity keeps finding it.
+//
+// Everything lives inside the World with a fixed capacity and refers to itself by index, so a world holds no pointers
+// and can be copied. Component ids and their sizes are the owner's, given to world_init().
+#define ARCHETYPE_MAX_COMPONENTS 16
+#define ARCHETYPE_CHUNK_ROWS 64
+// Every column starts this aligned, so it can be streamed with vector loads.
+#define ARCHETYPE_ALIGN 16
+
+#define WORLD_MAX_TABLES 8
+#define WORLD_MAX_ENTITIES 2048
+#define WORLD_STORAGE_BYTES (64 * 1024)
+_Static_assert(WORLD_MAX_ENTITIES < SLOT_MAP_NONE, "entity slots are 16 bit");
+
+// Bit i is set when component i is in the set.
+typedef uint16_t ComponentMask;
+_Static_assert(ARCHETYPE_MAX_COMPONENTS <= 16, "a component set is a 16 bit mask");
+
+typedef struct
+{
+    ComponentMask components;
+    uint16_t capacity;
+    // Rows per chunk, the capacity when that is less than ARCHETYPE_CHUNK_ROWS.
+    uint16_t chunk_rows;
+    uint16_t count;
+    // Most rows live at once since world_init().
+    uint16_t high_water;
+    // Where the slots of its rows start in World.owners.
+    uint16_t first_owner;
+    // Where its first chunk starts in World.storage, and how far apart chunks are.
+    uint32_t storage;
+    uint32_t chunk_bytes;
+    // Where the column of each of its components starts in a chunk.
+    uint32_t column[ARCHETYPE_MAX_COMPONENTS];
+} Archetype;
+
+typedef struct
+{
+    uint16_t component_size[ARCHETYPE_MAX_COMPONENTS];
+    size_t components_count;
+    Archetype tables[WORLD_MAX_TABLES];
+    size_t tables_count;
+    size_t owners_used;
+    size_t storage_used;
+    // Live entities, and most of them at once since world_init(). The map reuses freed slots before taking fresh ones
+    // in order, so no slot at or past the high water mark was ever used.
+    size_t live;
+    size_t high_water;
+    SlotMap map;
+    SlotMapSlot slots[WORLD_MAX_ENTITIES];
+    // The table of the entity in each used slot.
+    uint8_t table_of[WORLD_MAX_ENTITIES];
+    // The slot of each row, table by table.
+    uint16_t owners[WORLD_MAX_ENTITIES];
+    _Alignas(ARCHETYPE_ALIGN) uint8_t storage[WORLD_STORAGE_BYTES];
+} World;
+
+// Zeroes the world, storage included, so worlds that went through the same spawns and despawns are equal byte for byte.
+void world_init(World *, const uint16_t *component_sizes, size_t components_count);
+// Adds a table for the entities with exactly `components`, with room for `capacity` of them. Tables are numbered from
+// 0 in the order they are added. Every table is added before anything spawns.
+size_t world_add_table(World *, ComponentMask components, size_t capacity);
+// Spawns up to `count` entities into `table` and returns how many fit. They are the rows from the table's count before
+// the call on, with their components left for the caller to set. `handles` gets theirs unless it is NULL.
+size_t world_spawn(World *, size_t table, size_t count, Handle *handles);
+// The table and row of a live entity, or false once it is despawned.
+bool world_find(const World *, Handle handle, size_t *table, size_t *row);
+// The row of a live entity of `table`, or false when the handle names nothing there.
+bool world_find_in(const World *, Handle handle, size_t table, size_t *row);
+Handle world_handle(const World *, size_t table, size_t row);
+// Despawns an entity, moving the last row of its table into its place. Fails when it is already gone.
+bool world_despawn(World *, Handle handle);
+void world_despawn_row(World *, size_t table, size_t row);
+// Despawns every entity of `table` at once.
+void world_clear(World *, size_t table);
+// Despawns the entity of a row and spawns a new one in its place, leaving every other row where it is. Its components
+// are left for the caller to set.
+Handle world_replace_row(World *, size_t table, size_t row);
+// Moves rows [first, count) of a table in front of rows [0, first), both keeping their order, so row `first` becomes
+// row 0. Handles keep finding their entities.
+void world_rotate(World *, size_t table, size_t first);
+
+// The accessors below run for every chunk and entity a system touches, so they are inline.
+
+// A component of one row. Takes a const world like strchr() takes a const string, writing through the result is up to
+// the caller.
+static inline void *world_get(const World *world, size_t table, size_t component, size_t row)
+{
+    const Archetype *archetype = &world->tables[table];
+    assert(archetype->components & (1u << component));
+    size_t chunk = row / archetype->chunk_rows;
+    size_t offset = archetype->storage + chunk * archetype->chunk_bytes + archetype->column[component] +
+                    (row % archetype->chunk_rows) * world->component_size[component];
+    return (void *)&world->storage[offset];
+}
+
+// Rows [first, first + count) of a table, with the column of each of its components, NULL for the others.
+typedef struct
+{
+    size_t table;
+    size_t first;
+    size_t count;
+    void *columns[ARCHETYPE_MAX_COMPONENTS];
+} ArchetypeChunk;
+
+static inline size_t world_chunks_count(const World *world, size_t table)
+{
+    const Archetype *archetype = &world->tables[table];
+    return (archetype->count + archetype->chunk_rows - 1) / archetype->chunk_rows;
+}
+
+static inline ArchetypeChunk world_chunk(const World *world, size_t table, size_t chunk)
+{
+    const Archetype *archetype = &world->tables[table];
+    size_t first = chunk * archetype->chunk_rows;
+    ArchetypeChunk result = {
+        .table = table,
+        .first = first,
+        .count = archetype->count - first < archetype->chunk_rows ? archetype->count - first : archetype->chunk_rows,
+    };
+    uint8_t *base = (uint8_t *)&world->storage[archetype->storage + chunk * archetype->chunk_bytes];
+    for (ComponentMask components = archetype->components; components != 0; components &= components - 1)
+    {
+        size_t component = __builtin_ctz(components);
+        result.columns[component] = base + archetype->column[component];
+    }
+    return result;
+}
+
+// The chunks of every table that has all the components of `with` and none of `without`, in table order. Loop with
+//     WorldQuery query = world_query(with, without);
+//     for (ArchetypeChunk chunk; world_query_next(world, &query, &chunk);)
+typedef struct
+{
+    ComponentMask with;
+    ComponentMask without;
+    size_t table;
+    size_t chunk;
+} WorldQuery;
+
+static inline WorldQuery world_query(ComponentMask with, ComponentMask without)
+{
+    return (WorldQuery){.with = with, .without = without};
+}
+
+static inline bool world_query_next(const World *world, WorldQuery *query, ArchetypeChunk *chunk)
+{
+    for (; query->table < world->tables_count; ++query->table, query->chunk = 0)
+    {
+        ComponentMask components = world->tables[query->table].components;
+        if ((components & query->with) != query->with || (components & query->without) != 0)
+        {
+            continue;
+        }
+        if (query->chunk < world_chunks_count(world, query->table))
+        {
+            *chunk = world_chunk(world, query->table, query->chunk++);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,204 @@
+#include "batch.h"
+#include "game.h"
+#include "headless.h"
+#include "math.h"
+#include "nob.h"
+#include "thread_pool.h"
+
+typedef struct
+{
+    GameConfig config;
+    uint64_t seed;
+    size_t max_frames;
+    float dt;
+
+    Status status;
+    uint16_t score;
+    size_t frames;
+    size_t bullets_high_water;
+    uint64_t nanos;
+} BatchGame;
+
+static void play_game(void *data)
+{
+    BatchGame *game = data;
+    State state;
+    game_init(&state, &game->config, game->seed);
+
+    uint64_t start = nob_nanos_since_unspecified_epoch();
+
+    size_t frame = 0;
+    while (frame < game->max_frames && state.status != WON && state.status != LOST)
+    {
+        game_update(&state, headless_scripted_input(frame, &state), game->dt);
+        frame += 1;
+    }
+
+    game->nanos = nob_nanos_since_unspecified_epoch() - start;
+    game->frames = frame;
+    game->status = state.status;
+    game->score = state.score;
+    game->bullets_high_water = state.world.tables[TABLE_ENEMY_BULLETS].high_water;
+}
+
+bool batch_parse_sweep(BatchSweep *sweep, const char *list, float min, float max, bool whole)
+{
+    sweep->count = 0;
+
+    const char *cursor = list;
+    while (*cursor != '\0')
+    {
+        if (sweep->count >= BATCH_MAX_SWEEP_VALUES)
+        {
+            nob_log(NOB_ERROR, "at most %d values can be swept, got `%s`", BATCH_MAX_SWEEP_VALUES, list);
+            return false;
+        }
+
+        char *end = NULL;
+        float value = strtof(cursor, &end);
+        if (end == cursor || (*end != ',' && *end != '\0'))
+        {
+            nob_log(NOB_ERROR, "could not parse `%s` as a list of numbers", list);
+            return false;
+        }
+        // Written so NaN fails too.
+        if (!(value >= min && value <= max) || (whole && value != truncf(value)))
+        {
+            nob_log(NOB_ERROR, "`%.*s` in `%s` is not a %s from %g to %g", (int)(end - cursor), cursor, list,
+                    whole ? "whole number" : "number", min, max);
+            return false;
+        }
+        sweep->values[sweep->count++] = value;
+
+        cursor = *end == ',' ? end + 1 : end;
+    }
+
+    return sweep->count > 0;
+}
+
+static const char *result_name(Status status)
+{
+    switch (status)
+    {
+    case WON:
+        return "won";
+    case LOST:
+        return "lost";
+    default:
+        return "timeout";
+    }
+}
+
+int run_batch(const BatchOptions *options)
+{
+    size_t configs = options->fire_timer_min_ms.count * options->fire_timer_max_ms.count *
+                     options->enemy_speed.count * options->bullet_damage.count;
+    size_t games_count = configs * options->games_per_config;
+
+    BatchGame *games = calloc(games_count, sizeof(*games));
+    if (games == NULL)
+    {
+        nob_log(NOB_ERROR, "could not allocate %zu games", games_count);
+        return 1;
+    }
+
+    size_t index = 0;
+    for (size_t a = 0; a < options->fire_timer_min_ms.count; ++a)
+    {
+        for (size_t b = 0; b < options->fire_timer_max_ms.count; ++b)
+        {
+            for (size_t c = 0; c < options->enemy_speed.count; ++c)
+            {
+                for (size_t d = 0; d < options->bullet_damage.count; ++d)
+                {
+                    GameConfig config = {
+                        .fire_timer_min_ms = options->fire_timer_min_ms.values[a],
+                        .fire_timer_max_ms = options->fire_timer_max_ms.values[b],
+                        .enemy_speed = options->enemy_speed.values[c],
+                        .bullet_damage = options->bullet_damage.values[d],
+                    };
+
+                    if (config.fire_timer_min_ms > config.fire_timer_max_ms)
+                    {
+                        config.fire_timer_max_ms = config.fire_timer_min_ms;
+                    }
+
+                    for (size_t g = 0; g < options->games_per_config; ++g)
+                    {
+                        games[index++] = (BatchGame){
+                            .config = config,
+                            .seed = options->seed + g,
+                            .max_frames = options->max_frames,
+                            .dt = options->dt,
+                        };
+                    }
+                }
+            }
+        }
+    }
+
+    ThreadPool pool = {0};
+    if (!thread_pool_init(&pool, options->threads))
+    {
+        nob_log(NOB_ERROR, "could not start the thread pool");
+        free(games);
+        return 1;
+    }
+
+    uint64_t start = nob_nanos_since_unspecified_epoch();
+
+    for (size_t i = 0; i < games_count; ++i)
+    {
+        thread_pool_submit(&pool, play_game, &games[i]);
+    }
+    thread_pool_wait(&pool);
+
+    uint64_t elapsed = nob_nanos_since_unspecified_epoch() - start;
+    size_t threads = pool.workers_count;
+    thread_pool_destroy(&pool);
+
+    Nob_String_Builder csv = {0};
+    nob_sb_append_cstr(&csv, "game,seed,fire_timer_min_ms,fire_timer_max_ms,enemy_speed,bullet_damage,result,score,"
+                             "frames,ns_per_frame,bullets_high_water\n");
+
+    size_t total_frames = 0;
+    for (size_t i = 0; i < games_count; ++i)
+    {
+        const BatchGame *game = &games[i];
+        total_frames += game->frames;
+        nob_sb_appendf(&csv, "%zu,%llu,%u,%u,%g,%u,%s,%u,%zu,%.1f,%zu\n", i, (unsigned long long)game->seed,
+                       game->config.fire_timer_min_ms, game->config.fire_timer_max_ms, game->config.enemy_speed,
+                       game->config.bullet_damage, result_name(game->status), game->score, game->frames,
+                       game->frames > 0 ? (double)game->nanos / game->frames : 0.0, game->bullets_high_water);
+    }
+
+    bool written = nob_write_entire_file(options->output_path, csv.items, csv.count);
+    nob_sb_free(csv);
+
+    printf("%-10s %-10s %-12s %-8s %-8s %-10s %-10s\n", "fire_min", "fire_max", "enemy_speed", "damage", "won",
+           "avg_score", "avg_frames");
+    for (size_t i = 0; i < games_count; i += options->games_per_config)
+    {
+        size_t won = 0;
+        double score = 0;
+        double frames = 0;
+        for (size_t g = i; g < i + options->games_per_config; ++g)
+        {
+            won += games[g].status == WON;
+            score += games[g].score;
+            frames += games[g].frames;
+        }
+
+        printf("%-10u %-10u %-12g %-8u %-8.3f %-10.1f %-10.1f\n", games[i].config.fire_timer_min_ms,
+               games[i].config.fire_timer_max_ms, games[i].config.enemy_speed, games[i].config.bullet_damage,
+               (double)won / options->games_per_config, score / options->games_per_config,
+               frames / options->games_per_config);
+    }
+
+    double seconds = (double)elapsed / NOB_NANOS_PER_SEC;
+    printf("%zu games, %zu frames in %.3f s on %zu threads (%.0f frames per second)\n", games_count, total_frames,
+           seconds, threads, seconds > 0 ? total_frames / seconds : 0.0);
+
+    free(games);
+    return written ? 0 : 1;
+}
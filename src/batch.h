@@ -0,0 +1,36 @@
+#pragma once
+
+#include "stdbool.h"
+#include "stddef.h"
+#include "stdint.h"
+
+#define BATCH_MAX_SWEEP_VALUES 16
+
+// Every value in a sweep is crossed with every value of the other sweeps, and each combination is played
+// `games_per_config` times with consecutive seeds.
+typedef struct
+{
+    float values[BATCH_MAX_SWEEP_VALUES];
+    size_t count;
+} BatchSweep;
+
+typedef struct
+{
+    size_t games_per_config;
+    size_t max_frames;
+    size_t threads;
+    uint64_t seed;
+    float dt;
+    const char *output_path;
+
+    BatchSweep fire_timer_min_ms;
+    BatchSweep fire_timer_max_ms;
+    BatchSweep enemy_speed;
+    BatchSweep bullet_damage;
+} BatchOptions;
+
+// Parses a comma separated list like `0.1,0.2,0.4` into `sweep`. Every value must be within [min, max], and a whole
+// number when `whole` is set, so it fits the GameConfig field it is swept over instead of being cut to fit.
+bool batch_parse_sweep(BatchSweep *sweep, const char *list, float min, float max, bool whole);
+// Plays every game on a thread pool and writes one CSV row per game to `options->output_path`.
+int run_batch(const BatchOptions *options);
@@ -0,0 +1,534 @@
+#include "accumulator.h"
+#include "bench.h"
+#include "bench_collision.h"
+#include "game.h"
+#include "headless.h"
+#include "nob.h"
+#include "render_list.h"
+#include "rng.h"
+#include "sprite_batch.h"
+#include "thread_pool.h"
+#include "timer_wheel.h"
+
+#include "inttypes.h"
+#include "math.h"
+#include "stdlib.h"
+
+typedef struct
+{
+    const char *name;
+    const char *description;
+    int (*run)(const BenchOptions *options);
+} Bench;
+
+static float random_float(Rng *rng, float min, float max)
+{
+    return min + (max - min) * (rng_next(rng) / 4294967296.0f);
+}
+
+static Rectangle random_box(Rng *rng, float world_size, float width, float height)
+{
+    return (Rectangle){
+        .x = random_float(rng, 0, world_size),
+        .y = random_float(rng, 0, world_size),
+        .width = width,
+        .height = height,
+    };
+}
+
+// What check_collisions() used to do: raylib's scalar test against an array of rectangles.
+static int first_hit_raylib(const Rectangle *targets, size_t count, Rectangle box)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (CheckCollisionRecs(targets[i], box))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+#define AABB_QUERIES 1024
+
+// Bullet sized queries against enemy sized targets, sparse enough that most queries scan far before a hit.
+static int bench_aabb(const BenchOptions *options)
+{
+    static const size_t sizes[] = {4, 8, 24, 64, 256, 1024, 4096};
+
+    printf("%-8s %-18s %-12s %-8s\n", "targets", "kernel", "ns/query", "speedup");
+
+    int result = 0;
+    for (size_t s = 0; s < NOB_ARRAY_LEN(sizes); ++s)
+    {
+        size_t count = sizes[s];
+        Rng rng;
+        rng_seed(&rng, options->seed);
+
+        float world_size = 4.0f * sqrtf(count);
+        Rectangle *targets = malloc(count * sizeof(*targets));
+        float *storage = malloc(4 * count * sizeof(*storage));
+        CollisionBoxes boxes;
+        collision_boxes_init(&boxes, storage, count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            targets[i] = random_box(&rng, world_size, 1, 1);
+            collision_boxes_push(&boxes, targets[i]);
+        }
+
+        Rectangle queries[AABB_QUERIES];
+        for (size_t i = 0; i < AABB_QUERIES; ++i)
+        {
+            queries[i] = random_box(&rng, world_size, .3f, .3f);
+        }
+
+        size_t rounds = ((size_t)1 << 24) / (count * AABB_QUERIES);
+        rounds = rounds > 0 ? rounds : 1;
+
+        int64_t expected = 0;
+        double baseline = 0;
+        for (int kernel = -1; kernel < COLLISION_KERNEL_COUNT; ++kernel)
+        {
+            if (kernel >= 0 && !collision_kernel_supported(kernel))
+            {
+                continue;
+            }
+
+            int64_t checksum = 0;
+            uint64_t start = nob_nanos_since_unspecified_epoch();
+            for (size_t r = 0; r < rounds; ++r)
+            {
+                for (size_t q = 0; q < AABB_QUERIES; ++q)
+                {
+                    checksum += kernel < 0 ? first_hit_raylib(targets, count, queries[q])
+                                           : collision_first_hit_with(kernel, &boxes, queries[q]);
+                }
+            }
+            double ns = (double)(nob_nanos_since_unspecified_epoch() - start) / (rounds * AABB_QUERIES);
+
+            if (kernel < 0)
+            {
+                expected = checksum;
+                baseline = ns;
+            }
+            else if (checksum != expected)
+            {
+                nob_log(NOB_ERROR, "%s kernel disagrees with CheckCollisionRecs on %zu targets",
+                        collision_kernel_name(kernel), count);
+                result = 1;
+            }
+
+            printf("%-8zu %-18s %-12.1f %-8.2f\n", count,
+                   kernel < 0 ? "CheckCollisionRecs" : collision_kernel_name(kernel), ns, baseline / ns);
+        }
+
+        free(storage);
+        free(targets);
+    }
+
+    return result;
+}
+
+#define GRID_CELL_SIZE 2.0f
+
+// The same sparse scene as bench_aabb, once per tick: either every bullet scans all targets, or the grid is rebuilt
+// and every bullet only scans its own cells.
+static int bench_grid(const BenchOptions *options)
+{
+    static const size_t sizes[] = {10, 100, 1000, 10000, 100000};
+
+    printf("%-8s %-14s %-12s %-14s %-14s %-8s\n", "targets", "brute ns/tick", "build ns", "ns/query", "grid ns/tick",
+           "speedup");
+
+    int result = 0;
+    for (size_t s = 0; s < NOB_ARRAY_LEN(sizes); ++s)
+    {
+        size_t count = sizes[s];
+        Rng rng;
+        rng_seed(&rng, options->seed);
+
+        float world_size = 4.0f * sqrtf(count);
+        float *storage = malloc(4 * count * sizeof(*storage));
+        CollisionBoxes boxes;
+        collision_boxes_init(&boxes, storage, count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            collision_boxes_push(&boxes, random_box(&rng, world_size, 1, 1));
+        }
+
+        Rectangle queries[AABB_QUERIES];
+        for (size_t i = 0; i < AABB_QUERIES; ++i)
+        {
+            queries[i] = random_box(&rng, world_size, .3f, .3f);
+        }
+
+        // Unit boxes span at most 2 x 2 cells of a size of at least 1.
+        size_t cells_per_side = (size_t)ceilf(world_size / GRID_CELL_SIZE) + 1;
+        size_t items_capacity = 4 * count;
+        uint32_t *cell_start = malloc((cells_per_side * cells_per_side + 1) * sizeof(*cell_start));
+        uint32_t *index = malloc(items_capacity * sizeof(*index));
+        float *item_storage = malloc(4 * items_capacity * sizeof(*item_storage));
+        CollisionGrid grid;
+        collision_grid_init(&grid, (Vector2){0}, GRID_CELL_SIZE, cells_per_side, cells_per_side, cell_start, index,
+                            item_storage, items_capacity);
+
+        size_t rounds = ((size_t)1 << 24) / (count * AABB_QUERIES);
+        rounds = rounds > 0 ? rounds : 1;
+
+        int64_t expected = 0;
+        uint64_t start = nob_nanos_since_unspecified_epoch();
+        for (size_t r = 0; r < rounds; ++r)
+        {
+            for (size_t q = 0; q < AABB_QUERIES; ++q)
+            {
+                expected += collision_first_hit(&boxes, queries[q]);
+            }
+        }
+        double brute = (double)(nob_nanos_since_unspecified_epoch() - start) / rounds;
+
+        // Rebuilding is cheap next to brute force even for small sets, so give it enough rounds to be measurable.
+        size_t grid_rounds = rounds * 16;
+        start = nob_nanos_since_unspecified_epoch();
+        for (size_t r = 0; r < grid_rounds; ++r)
+        {
+            if (!collision_grid_build(&grid, &boxes))
+            {
+                nob_log(NOB_ERROR, "grid ran out of items on %zu targets", count);
+                return 1;
+            }
+        }
+        double build = (double)(nob_nanos_since_unspecified_epoch() - start) / grid_rounds;
+
+        int64_t checksum = 0;
+        start = nob_nanos_since_unspecified_epoch();
+        for (size_t r = 0; r < grid_rounds; ++r)
+        {
+            for (size_t q = 0; q < AABB_QUERIES; ++q)
+            {
+                checksum += collision_grid_first_hit(&grid, queries[q], 0, count);
+            }
+        }
+        double query = (double)(nob_nanos_since_unspecified_epoch() - start) / (grid_rounds * AABB_QUERIES);
+
+        if (checksum != expected * 16)
+        {
+            nob_log(NOB_ERROR, "grid disagrees with brute force on %zu targets", count);
+            result = 1;
+        }
+
+        double tick = build + query * AABB_QUERIES;
+        printf("%-8zu %-14.0f %-12.0f %-14.1f %-14.0f %-8.2f\n", count, brute, build, query, tick, brute / tick);
+
+        free(item_storage);
+        free(index);
+        free(cell_start);
+        free(storage);
+    }
+
+    return result;
+}
+
+#define TIMER_TICKS 4096
+#define TIMER_MS_PER_TICK 16
+
+// Timers with enemy fire intervals, restarted whenever they go off, polled every tick against kept on a wheel. Both
+// count the timers that fired, which must agree.
+static int bench_timers(const BenchOptions *options)
+{
+    static const size_t sizes[] = {10, 100, 1000, 10000, 60000};
+
+    printf("%-8s %-14s %-14s %-12s %-8s\n", "timers", "poll ns/tick", "wheel ns/tick", "fired/tick", "speedup");
+
+    int result = 0;
+    for (size_t s = 0; s < NOB_ARRAY_LEN(sizes); ++s)
+    {
+        size_t count = sizes[s];
+        Rng rng;
+        rng_seed(&rng, options->seed);
+
+        uint16_t *intervals = malloc(count * sizeof(*intervals));
+        uint32_t *next_ms = malloc(count * sizeof(*next_ms));
+        Accumulator *accumulators = malloc(count * sizeof(*accumulators));
+        TimerNode *nodes = malloc(count * sizeof(*nodes));
+        for (size_t i = 0; i < count; ++i)
+        {
+            intervals[i] = rng_range(&rng, 5000, 30000);
+            accumulators[i] = (Accumulator){.ns_to_trigger = intervals[i] * ACCUMULATOR_NS_PER_MS};
+        }
+
+        size_t polled = 0;
+        uint64_t start = nob_nanos_since_unspecified_epoch();
+        for (size_t tick = 0; tick < TIMER_TICKS; ++tick)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                polled += accumulator_tick(&accumulators[i], TIMER_MS_PER_TICK * ACCUMULATOR_NS_PER_MS,
+                                           When_Tick_Ends_Restart);
+            }
+        }
+        double poll = (double)(nob_nanos_since_unspecified_epoch() - start) / TIMER_TICKS;
+
+        // The same cadence as the accumulators: the n-th firing is on the first tick that ends at n intervals or later.
+        TimerWheel wheel;
+        timer_wheel_init(&wheel, nodes, count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            next_ms[i] = intervals[i];
+            timer_wheel_schedule(&wheel, nodes, i, (next_ms[i] + TIMER_MS_PER_TICK - 1) / TIMER_MS_PER_TICK, 0);
+        }
+
+        size_t fired = 0;
+        start = nob_nanos_since_unspecified_epoch();
+        for (size_t tick = 0; tick < TIMER_TICKS; ++tick)
+        {
+            timer_wheel_advance(&wheel, nodes);
+            for (uint16_t id; (id = timer_wheel_pop(&wheel, nodes)) != TIMER_NONE;)
+            {
+                next_ms[id] += intervals[id];
+                timer_wheel_schedule(&wheel, nodes, id, (next_ms[id] + TIMER_MS_PER_TICK - 1) / TIMER_MS_PER_TICK, 0);
+                fired += 1;
+            }
+        }
+        double turn = (double)(nob_nanos_since_unspecified_epoch() - start) / TIMER_TICKS;
+
+        if (fired != polled)
+        {
+            nob_log(NOB_ERROR, "wheel fired %zu times where polling fired %zu on %zu timers", fired, polled, count);
+            result = 1;
+        }
+
+        printf("%-8zu %-14.0f %-14.0f %-12.2f %-8.2f\n", count, poll, turn, (double)fired / TIMER_TICKS, poll / turn);
+
+        free(nodes);
+        free(accumulators);
+        free(next_ms);
+        free(intervals);
+    }
+
+    return result;
+}
+
+#define ACCUMULATOR_COUNT 1024
+#define ACCUMULATOR_SECONDS 120
+
+// Restarting accumulators with periods from an animation frame to a fire interval, ticked through the same stretch of
+// time at several tick rates. Whatever the rate, the n-th trigger must land on the first tick that ends at n periods or
+// later, so the schedules agree up to one tick.
+static int bench_accumulator(const BenchOptions *options)
+{
+    static const uint32_t rates[] = {30, 60, 144, 1000};
+
+    printf("%-6s %-10s %-10s %-14s %-14s\n", "hz", "ticks", "triggers", "max late ms", "ns/accumulator");
+
+    uint64_t *periods = malloc(ACCUMULATOR_COUNT * sizeof(*periods));
+    uint64_t *triggers = malloc(ACCUMULATOR_COUNT * sizeof(*triggers));
+    Accumulator *accumulators = malloc(ACCUMULATOR_COUNT * sizeof(*accumulators));
+    bool *fired = malloc(ACCUMULATOR_COUNT * sizeof(*fired));
+
+    Rng rng;
+    rng_seed(&rng, options->seed);
+    for (size_t i = 0; i < ACCUMULATOR_COUNT; ++i)
+    {
+        periods[i] = rng_range(&rng, 40, 30000) * ACCUMULATOR_NS_PER_MS + rng_range(&rng, 0, 999999);
+    }
+
+    int result = 0;
+    for (size_t r = 0; r < NOB_ARRAY_LEN(rates); ++r)
+    {
+        uint64_t dt_ns = accumulator_ns(1.0f / rates[r]);
+        size_t ticks = (size_t)ACCUMULATOR_SECONDS * rates[r];
+        for (size_t i = 0; i < ACCUMULATOR_COUNT; ++i)
+        {
+            accumulators[i] = (Accumulator){.ns_to_trigger = periods[i]};
+            triggers[i] = 0;
+        }
+
+        size_t total = 0;
+        uint64_t max_late_ns = 0;
+        uint64_t spent = 0;
+        for (size_t tick = 1; tick <= ticks; ++tick)
+        {
+            uint64_t start = nob_nanos_since_unspecified_epoch();
+            total += accumulator_tick_all(accumulators, ACCUMULATOR_COUNT, dt_ns, When_Tick_Ends_Restart, fired);
+            spent += nob_nanos_since_unspecified_epoch() - start;
+
+            uint64_t now_ns = tick * dt_ns;
+            for (size_t i = 0; i < ACCUMULATOR_COUNT; ++i)
+            {
+                if (!fired[i])
+                {
+                    continue;
+                }
+                triggers[i] += 1;
+                uint64_t due_ns = triggers[i] * periods[i];
+                if (due_ns > now_ns || now_ns - due_ns >= dt_ns)
+                {
+                    nob_log(NOB_ERROR, "trigger %" PRIu64 " of a %" PRIu64 " ns period at %u Hz is on tick %zu",
+                            triggers[i], periods[i], rates[r], tick);
+                    result = 1;
+                }
+                else if (now_ns - due_ns > max_late_ns)
+                {
+                    max_late_ns = now_ns - due_ns;
+                }
+            }
+        }
+
+        printf("%-6u %-10zu %-10zu %-14.3f %-14.2f\n", rates[r], ticks, total, max_late_ns / 1e6,
+               (double)spent / ((double)ticks * ACCUMULATOR_COUNT));
+    }
+
+    free(fired);
+    free(accumulators);
+    free(triggers);
+    free(periods);
+
+    return result;
+}
+
+#define SPRITE_FRAMES 20000
+
+// Every frame of a scripted game recorded into a render list and built into the sprite batch, as the window does once
+// per tick. Counts the commands and the vertices flushing would submit without a GPU, and checks them against the
+// sprites the state holds. How many draws rlgl turns them into is only known to rlgl, with a GPU.
+static int bench_sprites(const BenchOptions *options)
+{
+    static RenderList list;
+    static SpriteBatch batch;
+    SpriteUvs uvs;
+    sprite_uvs_init(&uvs, 256, 256);
+
+    State state;
+    GameConfig config = game_default_config();
+    game_init(&state, &config, options->seed);
+
+    int result = 0;
+    size_t sprites = 0;
+    size_t max_sprites = 0;
+    size_t vertices = 0;
+    uint64_t record_ns = 0;
+    uint64_t build_ns = 0;
+    for (size_t frame = 0; frame < SPRITE_FRAMES; ++frame)
+    {
+        game_update(&state, headless_scripted_input(frame, &state), SIMULATION_DT);
+
+        uint64_t start = nob_nanos_since_unspecified_epoch();
+        render_list_record_game(&list, &state, 0.5f, 64.0f, (Vector2){16, 16});
+        uint64_t recorded = nob_nanos_since_unspecified_epoch();
+        sprite_batch_build(&batch, &uvs, &list);
+        record_ns += recorded - start;
+        build_ns += nob_nanos_since_unspecified_epoch() - recorded;
+
+        size_t expected = state.world.live;
+
+        SpriteBatchStats stats = sprite_batch_stats(&batch);
+        if (list.count != expected || stats.sprites != expected || stats.vertices != 4 * expected)
+        {
+            nob_log(NOB_ERROR, "frame %zu recorded %zu commands and %zu vertices for %zu sprites", frame, list.count,
+                    stats.vertices, expected);
+            result = 1;
+            break;
+        }
+
+        sprites += stats.sprites;
+        max_sprites = stats.sprites > max_sprites ? stats.sprites : max_sprites;
+        vertices += stats.vertices;
+    }
+
+    printf("%-8s %-12s %-12s %-16s %-12s %-10s\n", "frames", "commands", "max commands", "vertices/frame", "record ns",
+           "build ns");
+    printf("%-8d %-12.1f %-12zu %-16.1f %-12.0f %-10.0f\n", SPRITE_FRAMES, (double)sprites / SPRITE_FRAMES, max_sprites,
+           (double)vertices / SPRITE_FRAMES, (double)record_ns / SPRITE_FRAMES, (double)build_ns / SPRITE_FRAMES);
+
+    return result;
+}
+
+#define FRAME_TICKS 20000
+#define FRAME_WORKERS 4
+
+// The same scripted game ticked with its jobs in order on one thread, and wave by wave on a work stealing pool. Both
+// must end in the same state byte for byte.
+static int bench_frame(const BenchOptions *options)
+{
+    FrameGraph graph;
+    game_tick_graph(&graph);
+    for (size_t wave = 0; wave < graph.waves_count; ++wave)
+    {
+        printf("wave %zu:", wave);
+        for (size_t i = 0; i < graph.count; ++i)
+        {
+            if (graph.wave[i] == wave)
+            {
+                printf(" [%s]", graph.jobs[i].name);
+            }
+        }
+        printf("\n");
+    }
+
+    ThreadPool pool;
+    if (!thread_pool_init(&pool, FRAME_WORKERS))
+    {
+        nob_log(NOB_ERROR, "could not start %d workers", FRAME_WORKERS);
+        return 1;
+    }
+
+    static State serial;
+    static State parallel;
+    GameConfig config = game_default_config();
+    game_init(&serial, &config, options->seed);
+    game_init(&parallel, &config, options->seed);
+
+    uint64_t start = nob_nanos_since_unspecified_epoch();
+    for (size_t tick = 0; tick < FRAME_TICKS; ++tick)
+    {
+        game_update(&serial, headless_scripted_input(tick, &serial), SIMULATION_DT);
+    }
+    double inline_ns = (double)(nob_nanos_since_unspecified_epoch() - start) / FRAME_TICKS;
+
+    start = nob_nanos_since_unspecified_epoch();
+    for (size_t tick = 0; tick < FRAME_TICKS; ++tick)
+    {
+        game_update_parallel(&parallel, headless_scripted_input(tick, &parallel), SIMULATION_DT, &graph, &pool);
+    }
+    double pool_ns = (double)(nob_nanos_since_unspecified_epoch() - start) / FRAME_TICKS;
+
+    thread_pool_destroy(&pool);
+
+    printf("%-8s %-14s %-14s\n", "ticks", "inline ns", "pool ns");
+    printf("%-8d %-14.0f %-14.0f\n", FRAME_TICKS, inline_ns, pool_ns);
+
+    if (memcmp(&serial, &parallel, sizeof(serial)) != 0)
+    {
+        nob_log(NOB_ERROR, "ticking on the pool ended in a different state");
+        return 1;
+    }
+    return 0;
+}
+
+static const Bench benches[] = {
+    {"aabb", "first hit of one box against N boxes, per collision kernel", bench_aabb},
+    {"grid", "a tick of bullets against N targets, brute force against the grid broadphase", bench_grid},
+    {"timers", "a tick of N fire timers, polled accumulators against the timing wheel", bench_timers},
+    {"accumulator", "accumulator trigger ticks at 30, 60, 144 and 1000 Hz against their exact times",
+     bench_accumulator},
+    {"sprites", "a scripted game recorded and batched every tick, with its command and vertex counts", bench_sprites},
+    {"frame", "a scripted game with its tick jobs run inline against wave by wave on a thread pool", bench_frame},
+};
+
+int run_bench(const BenchOptions *options)
+{
+    for (size_t i = 0; i < NOB_ARRAY_LEN(benches); ++i)
+    {
+        if (options->name != NULL && strcmp(options->name, benches[i].name) == 0)
+        {
+            return benches[i].run(options);
+        }
+    }
+
+    nob_log(NOB_ERROR, "unknown benchmark `%s`, available are:", options->name != NULL ? options->name : "");
+    for (size_t i = 0; i < NOB_ARRAY_LEN(benches); ++i)
+    {
+        nob_log(NOB_ERROR, "    %-8s %s", benches[i].name, benches[i].description);
+    }
+    return 1;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "stdint.h"
+
+typedef struct
+{
+    const char *name;
+    uint64_t seed;
+} BenchOptions;
+
+// Microbenchmarks of the simulation's hot spots, run by name from the command line.
+int run_bench(const BenchOptions *options);
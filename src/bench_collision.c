@@ -0,0 +1,194 @@
+#include "bench_collision.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define COLLISION_X86
+#include "immintrin.h"
+#endif
+
+static int first_hit_scalar(const CollisionBoxes *boxes, size_t start, Rectangle box)
+{
+    float max_x = box.x + box.width;
+    float max_y = box.y + box.height;
+
+    for (size_t i = start; i < boxes->count; ++i)
+    {
+        if (boxes->min_x[i] < max_x && boxes->max_x[i] > box.x && boxes->min_y[i] < max_y && boxes->max_y[i] > box.y)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+#ifdef COLLISION_X86
+
+static int first_hit_sse2(const CollisionBoxes *boxes, Rectangle box)
+{
+    __m128 min_x = _mm_set1_ps(box.x);
+    __m128 min_y = _mm_set1_ps(box.y);
+    __m128 max_x = _mm_set1_ps(box.x + box.width);
+    __m128 max_y = _mm_set1_ps(box.y + box.height);
+
+    size_t i = 0;
+    for (; i + 4 <= boxes->count; i += 4)
+    {
+        __m128 x = _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(boxes->min_x + i), max_x),
+                              _mm_cmpgt_ps(_mm_loadu_ps(boxes->max_x + i), min_x));
+        __m128 y = _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(boxes->min_y + i), max_y),
+                              _mm_cmpgt_ps(_mm_loadu_ps(boxes->max_y + i), min_y));
+        int mask = _mm_movemask_ps(_mm_and_ps(x, y));
+        if (mask != 0)
+        {
+            return i + __builtin_ctz(mask);
+        }
+    }
+
+    return first_hit_scalar(boxes, i, box);
+}
+
+__attribute__((target("avx2"))) static int first_hit_avx2(const CollisionBoxes *boxes, Rectangle box)
+{
+    __m256 min_x = _mm256_set1_ps(box.x);
+    __m256 min_y = _mm256_set1_ps(box.y);
+    __m256 max_x = _mm256_set1_ps(box.x + box.width);
+    __m256 max_y = _mm256_set1_ps(box.y + box.height);
+
+    size_t i = 0;
+    for (; i + 8 <= boxes->count; i += 8)
+    {
+        __m256 x = _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(boxes->min_x + i), max_x, _CMP_LT_OQ),
+                                 _mm256_cmp_ps(_mm256_loadu_ps(boxes->max_x + i), min_x, _CMP_GT_OQ));
+        __m256 y = _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(boxes->min_y + i), max_y, _CMP_LT_OQ),
+                                 _mm256_cmp_ps(_mm256_loadu_ps(boxes->max_y + i), min_y, _CMP_GT_OQ));
+        int mask = _mm256_movemask_ps(_mm256_and_ps(x, y));
+        if (mask != 0)
+        {
+            _mm256_zeroupper();
+            return i + __builtin_ctz(mask);
+        }
+    }
+
+    // GCC only inserts this itself at -O2 and up. Leaving the upper halves dirty makes all later SSE code pay for a
+    // state transition.
+    _mm256_zeroupper();
+    return first_hit_scalar(boxes, i, box);
+}
+
+#endif // COLLISION_X86
+
+bool collision_kernel_supported(CollisionKernel kernel)
+{
+    switch (kernel)
+    {
+    case COLLISION_KERNEL_SCALAR:
+        return true;
+#ifdef COLLISION_X86
+    case COLLISION_KERNEL_SSE2:
+        return __builtin_cpu_supports("sse2");
+    case COLLISION_KERNEL_AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+const char *collision_kernel_name(CollisionKernel kernel)
+{
+    switch (kernel)
+    {
+    case COLLISION_KERNEL_SCALAR:
+        return "scalar";
+    case COLLISION_KERNEL_SSE2:
+        return "sse2";
+    case COLLISION_KERNEL_AVX2:
+        return "avx2";
+    default:
+        return "?";
+    }
+}
+
+int collision_first_hit_with(CollisionKernel kernel, const CollisionBoxes *boxes, Rectangle box)
+{
+    switch (kernel)
+    {
+#ifdef COLLISION_X86
+    case COLLISION_KERNEL_SSE2:
+        return first_hit_sse2(boxes, box);
+    case COLLISION_KERNEL_AVX2:
+        return first_hit_avx2(boxes, box);
+#endif
+    default:
+        return first_hit_scalar(boxes, 0, box);
+    }
+}
+
+static CollisionKernel best_kernel = COLLISION_KERNEL_SCALAR;
+
+// Decided once before main() so the hot path is a single well predicted branch and threads never race on it.
+__attribute__((constructor)) static void pick_kernel(void)
+{
+#ifdef COLLISION_X86
+    __builtin_cpu_init();
+#endif
+    for (CollisionKernel kernel = COLLISION_KERNEL_SCALAR; kernel < COLLISION_KERNEL_COUNT; ++kernel)
+    {
+        if (collision_kernel_supported(kernel))
+        {
+            best_kernel = kernel;
+        }
+    }
+}
+
+int collision_first_hit(const CollisionBoxes *boxes, Rectangle box)
+{
+    // Fewer boxes than one AVX2 block would only run the scalar tail after paying for the 256 bit setup.
+    if (best_kernel == COLLISION_KERNEL_AVX2 && boxes->count < 8)
+    {
+        return collision_first_hit_with(COLLISION_KERNEL_SSE2, boxes, box);
+    }
+    return collision_first_hit_with(best_kernel, boxes, box);
+}
+
+int collision_grid_first_hit(const CollisionGrid *grid, Rectangle box, size_t first, size_t last)
+{
+    CollisionCellRange range = collision_grid_cells(grid, box.x, box.y, box.x + box.width, box.y + box.height);
+    size_t best = last;
+    for (size_t row = range.min_row; row <= range.max_row; ++row)
+    {
+        for (size_t column = range.min_column; column <= range.max_column; ++column)
+        {
+            size_t cell = row * grid->columns + column;
+            size_t start = grid->cell_start[cell];
+            size_t end = grid->cell_start[cell + 1];
+            // Items are ascending, so [first, best) is one run of the cell.
+            while (start < end && grid->index[start] < first)
+            {
+                start += 1;
+            }
+            while (end > start && grid->index[end - 1] >= best)
+            {
+                end -= 1;
+            }
+            if (start == end)
+            {
+                continue;
+            }
+
+            CollisionBoxes run = {
+                .min_x = grid->items.min_x + start,
+                .min_y = grid->items.min_y + start,
+                .max_x = grid->items.max_x + start,
+                .max_y = grid->items.max_y + start,
+                .count = end - start,
+                .capacity = end - start,
+            };
+            int hit = collision_first_hit(&run, box);
+            if (hit >= 0)
+            {
+                best = grid->index[start + hit];
+            }
+        }
+    }
+    return best < last ? (int)best : -1;
+}
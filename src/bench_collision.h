@@ -0,0 +1,26 @@
+#pragma once
+
+#include "collision.h"
+
+// Overlap tests of one box against many, with SSE2 and AVX2 kernels, for `--bench aabb` and `--bench grid` only. The
+// game sweeps bullets with collision_sweep() and collision_grid_first_sweep() against a handful of targets, where
+// testing several boxes per instruction does not pay off.
+typedef enum
+{
+    COLLISION_KERNEL_SCALAR,
+    COLLISION_KERNEL_SSE2,
+    COLLISION_KERNEL_AVX2,
+    COLLISION_KERNEL_COUNT,
+} CollisionKernel;
+
+// Index of the first box overlapping `box`, or -1. Overlap follows CheckCollisionRecs(): touching edges do not count.
+// Uses the widest kernel the CPU supports.
+int collision_first_hit(const CollisionBoxes *, Rectangle box);
+
+int collision_first_hit_with(CollisionKernel, const CollisionBoxes *, Rectangle box);
+bool collision_kernel_supported(CollisionKernel);
+const char *collision_kernel_name(CollisionKernel);
+
+// Lowest index in [first, last) whose box overlaps `box`, or -1. Same results as collision_first_hit() on that range
+// of the boxes the grid was built from.
+int collision_grid_first_hit(const CollisionGrid *, Rectangle box, size_t first, size_t last);
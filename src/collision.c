@@ -0,0 +1,221 @@
+#include "collision.h"
+
+#include "string.h"
+
+void collision_boxes_init(CollisionBoxes *boxes, float *storage, size_t capacity)
+{
+    boxes->min_x = storage;
+    boxes->min_y = storage + capacity;
+    boxes->max_x = storage + 2 * capacity;
+    boxes->max_y = storage + 3 * capacity;
+    boxes->count = 0;
+    boxes->capacity = capacity;
+}
+
+void collision_grid_init(CollisionGrid *grid, Vector2 origin, float cell_size, size_t columns, size_t rows,
+                         uint32_t *cell_start, uint32_t *index, float *item_storage, size_t items_capacity)
+{
+    grid->origin = origin;
+    grid->cell_size = cell_size;
+    grid->cells_per_unit = 1 / cell_size;
+    grid->columns = columns;
+    grid->rows = rows;
+    grid->cell_start = cell_start;
+    grid->index = index;
+    collision_boxes_init(&grid->items, item_storage, items_capacity);
+    memset(cell_start, 0, (columns * rows + 1) * sizeof(*cell_start));
+}
+
+static inline bool box_is_empty(const CollisionBoxes *boxes, size_t i)
+{
+    return !(boxes->min_x[i] <= boxes->max_x[i] && boxes->min_y[i] <= boxes->max_y[i]);
+}
+
+// A counting sort of (cell, box) pairs: count per cell, turn the counts into cell ends, then fill every cell backwards
+// starting from the last box, which leaves each cell ascending and cell_start[c] pointing at its first item.
+bool collision_grid_build(CollisionGrid *grid, const CollisionBoxes *boxes)
+{
+    // Everything the loops touch is copied into locals. The repo builds at -O, which leaves strict aliasing off, so
+    // every store through a float or index pointer would otherwise reload all of these.
+    uint32_t *cell_start = grid->cell_start;
+    uint32_t *index = grid->index;
+    CollisionBoxes items = grid->items;
+    size_t columns = grid->columns;
+    size_t cells = columns * grid->rows;
+
+    memset(cell_start, 0, (cells + 1) * sizeof(*cell_start));
+    grid->items.count = 0;
+
+    size_t total = 0;
+    for (size_t i = 0; i < boxes->count; ++i)
+    {
+        if (box_is_empty(boxes, i))
+        {
+            continue;
+        }
+
+        CollisionCellRange range =
+            collision_grid_cells(grid, boxes->min_x[i], boxes->min_y[i], boxes->max_x[i], boxes->max_y[i]);
+        for (size_t row = range.min_row; row <= range.max_row; ++row)
+        {
+            for (size_t column = range.min_column; column <= range.max_column; ++column)
+            {
+                cell_start[row * columns + column] += 1;
+            }
+        }
+        total += (range.max_row - range.min_row + 1) * (range.max_column - range.min_column + 1);
+    }
+
+    if (total > items.capacity)
+    {
+        memset(cell_start, 0, (cells + 1) * sizeof(*cell_start));
+        return false;
+    }
+
+    uint32_t end = 0;
+    for (size_t c = 0; c < cells; ++c)
+    {
+        end += cell_start[c];
+        cell_start[c] = end;
+    }
+    cell_start[cells] = total;
+
+    for (size_t i = boxes->count; i-- > 0;)
+    {
+        if (box_is_empty(boxes, i))
+        {
+            continue;
+        }
+
+        float min_x = boxes->min_x[i];
+        float min_y = boxes->min_y[i];
+        float max_x = boxes->max_x[i];
+        float max_y = boxes->max_y[i];
+        CollisionCellRange range = collision_grid_cells(grid, min_x, min_y, max_x, max_y);
+        for (size_t row = range.min_row; row <= range.max_row; ++row)
+        {
+            for (size_t column = range.min_column; column <= range.max_column; ++column)
+            {
+                uint32_t item = --cell_start[row * columns + column];
+                index[item] = i;
+                items.min_x[item] = min_x;
+                items.min_y[item] = min_y;
+                items.max_x[item] = max_x;
+                items.max_y[item] = max_y;
+            }
+        }
+    }
+    grid->items.count = total;
+    return true;
+}
+
+void collision_grid_remove(CollisionGrid *grid, size_t index, Rectangle box)
+{
+    CollisionCellRange range = collision_grid_cells(grid, box.x, box.y, box.x + box.width, box.y + box.height);
+    for (size_t row = range.min_row; row <= range.max_row; ++row)
+    {
+        for (size_t column = range.min_column; column <= range.max_column; ++column)
+        {
+            size_t cell = row * grid->columns + column;
+            for (size_t item = grid->cell_start[cell]; item < grid->cell_start[cell + 1]; ++item)
+            {
+                if (grid->index[item] == index)
+                {
+                    collision_boxes_set_empty(&grid->items, item);
+                }
+            }
+        }
+    }
+}
+
+// Narrows [*enter, *exit) to the times at which the box overlaps the target along one axis, or returns false if it never
+// does. Both bounds are open, so touching at either end is not a hit.
+static bool sweep_axis(float box_min, float box_max, float motion, float target_min, float target_max, float *enter,
+                       float *exit)
+{
+    if (motion == 0)
+    {
+        return box_min < target_max && box_max > target_min;
+    }
+
+    float from = (target_min - box_max) / motion;
+    float to = (target_max - box_min) / motion;
+    if (motion < 0)
+    {
+        float swap = from;
+        from = to;
+        to = swap;
+    }
+    *enter = from > *enter ? from : *enter;
+    *exit = to < *exit ? to : *exit;
+    return true;
+}
+
+static float sweep(float min_x, float min_y, float max_x, float max_y, Vector2 motion, float target_min_x,
+                   float target_min_y, float target_max_x, float target_max_y)
+{
+    float enter = -INFINITY;
+    float exit = INFINITY;
+    if (!sweep_axis(min_x, max_x, motion.x, target_min_x, target_max_x, &enter, &exit) ||
+        !sweep_axis(min_y, max_y, motion.y, target_min_y, target_max_y, &enter, &exit))
+    {
+        return -1;
+    }
+    if (!(enter < exit && enter < 1 && exit > 0))
+    {
+        return -1;
+    }
+    return enter > 0 ? enter : 0;
+}
+
+float collision_sweep(Rectangle box, Vector2 motion, Rectangle target)
+{
+    return sweep(box.x, box.y, box.x + box.width, box.y + box.height, motion, target.x, target.y,
+                 target.x + target.width, target.y + target.height);
+}
+
+int collision_grid_first_sweep(const CollisionGrid *grid, Rectangle box, Vector2 motion, size_t first, size_t last,
+                               float *time)
+{
+    float min_x = box.x;
+    float min_y = box.y;
+    float max_x = box.x + box.width;
+    float max_y = box.y + box.height;
+
+    // Every cell the box passes through is inside the bounds of where it starts and where it ends.
+    CollisionCellRange range =
+        collision_grid_cells(grid, fminf(min_x, min_x + motion.x), fminf(min_y, min_y + motion.y),
+                             fmaxf(max_x, max_x + motion.x), fmaxf(max_y, max_y + motion.y));
+    size_t best = last;
+    float best_time = INFINITY;
+    for (size_t row = range.min_row; row <= range.max_row; ++row)
+    {
+        for (size_t column = range.min_column; column <= range.max_column; ++column)
+        {
+            size_t cell = row * grid->columns + column;
+            for (size_t item = grid->cell_start[cell]; item < grid->cell_start[cell + 1]; ++item)
+            {
+                size_t index = grid->index[item];
+                if (index < first || index >= last)
+                {
+                    continue;
+                }
+
+                float t = sweep(min_x, min_y, max_x, max_y, motion, grid->items.min_x[item], grid->items.min_y[item],
+                                grid->items.max_x[item], grid->items.max_y[item]);
+                if (t >= 0 && (t < best_time || (t == best_time && index < best)))
+                {
+                    best = index;
+                    best_time = t;
+                }
+            }
+        }
+    }
+
+    if (best == last)
+    {
+        return -1;
+    }
+    *time = best_time;
+    return best;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "assert.h"
+#include "math.h"
+#include "raylib.h"
+#include "stdbool.h"
+#include "stddef.h"
+#include "stdint.h"
+
+// Axis aligned boxes packed as separate min/max arrays, so one instruction can test a box against several of them.
+typedef struct
+{
+    float *min_x;
+    float *min_y;
+    float *max_x;
+    float *max_y;
+    size_t count;
+    size_t capacity;
+} CollisionBoxes;
+
+// `storage` holds 4 * capacity floats and must outlive the boxes.
+void collision_boxes_init(CollisionBoxes *, float *storage, size_t capacity);
+
+// Uniform grid broadphase over a rectangle of the world, rebuilt from a set of boxes whenever they move.
+// Every box is filed under each cell it overlaps, so a query only tests the boxes in the few cells it touches instead of
+// all of them. Boxes outside the covered area are filed under the border cells, which keeps results exact.
+// Cell contents are copies of the boxes in ascending index order, laid out like CollisionBoxes.
+typedef struct
+{
+    Vector2 origin;
+    float cell_size;
+    // 1 / cell_size, so finding the cells of a box takes no division.
+    float cells_per_unit;
+    size_t columns;
+    size_t rows;
+
+    // Cell c holds items cell_start[c] up to cell_start[c + 1], it has columns * rows + 1 entries.
+    uint32_t *cell_start;
+    // Which box each item is a copy of.
+    uint32_t *index;
+    CollisionBoxes items;
+} CollisionGrid;
+
+// `cell_start` holds columns * rows + 1 entries, `index` items_capacity entries and `item_storage` 4 * items_capacity
+// floats. A box takes up one item per cell it overlaps.
+void collision_grid_init(CollisionGrid *, Vector2 origin, float cell_size, size_t columns, size_t rows,
+                         uint32_t *cell_start, uint32_t *index, float *item_storage, size_t items_capacity);
+// Returns false when the boxes need more items than the grid has room for.
+bool collision_grid_build(CollisionGrid *, const CollisionBoxes *boxes);
+// Empties every copy of box `index`, which must have been `box` when the grid was built. Cheaper than a rebuild when a
+// single target dies mid-tick.
+void collision_grid_remove(CollisionGrid *, size_t index, Rectangle box);
+
+// When `box` moving by `motion` first overlaps `target`, as a fraction of the motion in [0, 1], or -1 if it never does.
+// Overlap is strict like CheckCollisionRecs(), so a box that does not move hits exactly when it overlaps.
+float collision_sweep(Rectangle box, Vector2 motion, Rectangle target);
+// The box in [first, last) that `box` moving by `motion` hits earliest, the lowest index on ties, or -1. Stores the time
+// of impact in `time` on a hit.
+int collision_grid_first_sweep(const CollisionGrid *, Rectangle box, Vector2 motion, size_t first, size_t last,
+                               float *time);
+
+// The setters run for every target every tick, so they live here where they can be inlined.
+
+// The max edges are computed exactly like CheckCollisionRecs() does, so results match it bit for bit.
+static inline void collision_boxes_set(CollisionBoxes *boxes, size_t index, Rectangle box)
+{
+    boxes->min_x[index] = box.x;
+    boxes->min_y[index] = box.y;
+    boxes->max_x[index] = box.x + box.width;
+    boxes->max_y[index] = box.y + box.height;
+}
+
+// A box nothing overlaps, to keep indices of dead targets lined up with their entities.
+static inline void collision_boxes_set_empty(CollisionBoxes *boxes, size_t index)
+{
+    boxes->min_x[index] = INFINITY;
+    boxes->min_y[index] = INFINITY;
+    boxes->max_x[index] = -INFINITY;
+    boxes->max_y[index] = -INFINITY;
+}
+
+static inline void collision_boxes_push(CollisionBoxes *boxes, Rectangle box)
+{
+    assert(boxes->count < boxes->capacity);
+    collision_boxes_set(boxes, boxes->count++, box);
+}
+
+// Finding the cells of a box is shared with the overlap queries of bench_collision.c, so it lives here too.
+
+// Clamped while still a float, since truncating is flooring once negatives are gone and converting a float that is
+// known to be small to an int is a single instruction.
+static inline size_t collision_grid_coordinate(float world, float origin, float cells_per_unit, float last_cell)
+{
+    float cell = (world - origin) * cells_per_unit;
+    if (!(cell >= 0))
+    {
+        return 0;
+    }
+    return (int32_t)(cell < last_cell ? cell : last_cell);
+}
+
+typedef struct
+{
+    size_t min_column;
+    size_t max_column;
+    size_t min_row;
+    size_t max_row;
+} CollisionCellRange;
+
+// The cells of a grid that a box with these bounds overlaps, those along the border for the parts outside of it.
+static inline CollisionCellRange collision_grid_cells(const CollisionGrid *grid, float min_x, float min_y, float max_x,
+                                                      float max_y)
+{
+    float last_column = grid->columns - 1;
+    float last_row = grid->rows - 1;
+    return (CollisionCellRange){
+        .min_column = collision_grid_coordinate(min_x, grid->origin.x, grid->cells_per_unit, last_column),
+        .max_column = collision_grid_coordinate(max_x, grid->origin.x, grid->cells_per_unit, last_column),
+        .min_row = collision_grid_coordinate(min_y, grid->origin.y, grid->cells_per_unit, last_row),
+        .max_row = collision_grid_coordinate(max_y, grid->origin.y, grid->cells_per_unit, last_row),
+    };
+}
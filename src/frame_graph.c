@@ -0,0 +1,80 @@
+#include "frame_graph.h"
+#include "assert.h"
+
+static bool conflict(const FrameJob *a, const FrameJob *b)
+{
+    return (a->writes & (b->reads | b->writes)) != 0 || (b->writes & a->reads) != 0;
+}
+
+void frame_graph_init(FrameGraph *graph, const FrameJob *jobs, size_t count)
+{
+    assert(count <= FRAME_GRAPH_MAX_JOBS);
+    graph->jobs = jobs;
+    graph->count = count;
+    graph->waves_count = 0;
+    for (size_t j = 0; j < count; ++j)
+    {
+        uint8_t wave = 0;
+        for (size_t i = 0; i < j; ++i)
+        {
+            if (conflict(&jobs[i], &jobs[j]) && graph->wave[i] + 1 > wave)
+            {
+                wave = graph->wave[i] + 1;
+            }
+        }
+        graph->wave[j] = wave;
+        if (wave + 1u > graph->waves_count)
+        {
+            graph->waves_count = wave + 1;
+        }
+    }
+}
+
+void frame_graph_run(const FrameGraph *graph, void *context)
+{
+    for (size_t i = 0; i < graph->count; ++i)
+    {
+        graph->jobs[i].run(context);
+    }
+}
+
+typedef struct
+{
+    const FrameJob *job;
+    void *context;
+} Submitted;
+
+static void run_submitted(void *data)
+{
+    Submitted *submitted = data;
+    submitted->job->run(submitted->context);
+}
+
+void frame_graph_run_parallel(const FrameGraph *graph, void *context, ThreadPool *pool)
+{
+    Submitted submitted[FRAME_GRAPH_MAX_JOBS];
+    for (size_t wave = 0; wave < graph->waves_count; ++wave)
+    {
+        size_t count = 0;
+        size_t last = 0;
+        for (size_t i = 0; i < graph->count; ++i)
+        {
+            if (graph->wave[i] == wave)
+            {
+                submitted[count++] = (Submitted){.job = &graph->jobs[i], .context = context};
+                last = i;
+            }
+        }
+
+        if (count == 1)
+        {
+            graph->jobs[last].run(context);
+            continue;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            thread_pool_submit(pool, run_submitted, &submitted[i]);
+        }
+        thread_pool_wait(pool);
+    }
+}
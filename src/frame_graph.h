@@ -0,0 +1,34 @@
+#pragma once
+
+#include "stddef.h"
+#include "stdint.h"
+#include "thread_pool.h"
+
+// A frame's work as jobs that declare which parts of the state they read and write, as bits of a mask the owner
+// defines. Two jobs conflict when one writes something the other reads or writes, and a job runs in the wave after the
+// last earlier job it conflicts with. Jobs of one wave touch disjoint data, so running them at once, in any order, has
+// the same result as running every job in declared order.
+#define FRAME_GRAPH_MAX_JOBS 32
+
+typedef struct
+{
+    const char *name;
+    void (*run)(void *context);
+    uint32_t reads;
+    uint32_t writes;
+} FrameJob;
+
+typedef struct
+{
+    const FrameJob *jobs;
+    size_t count;
+    uint8_t wave[FRAME_GRAPH_MAX_JOBS];
+    size_t waves_count;
+} FrameGraph;
+
+void frame_graph_init(FrameGraph *, const FrameJob *jobs, size_t count);
+// Runs every job on the calling thread, in declared order.
+void frame_graph_run(const FrameGraph *, void *context);
+// Runs the jobs of each wave on `pool`, and the next wave once they all finished. A wave of one job runs on the calling
+// thread.
+void frame_graph_run_parallel(const FrameGraph *, void *context, ThreadPool *pool);
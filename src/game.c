@@ -0,0 +1,1325 @@
+#include "game.h"
+#include "collision.h"
+#include "frame_graph.h"
+#include "nob.h"
+#include "raymath.h"
+
+static const AtlasDefinition squid_frames = {
+    .width = 16,
+    .height = 16,
+    .pieces_count = 2,
+    .offset_height = 0,
+    .offset_width = 0,
+    .pieces = {{
+                   .x = 0,
+                   .y = 1,
+               },
+               {
+                   .x = 1,
+                   .y = 1,
+               }},
+};
+
+static const AtlasDefinition squid_bullet_frames = {
+    .width = 16,
+    .height = 16,
+    .offset_width = 0,
+    .offset_height = 0,
+    .pieces_count = 2,
+    .pieces =
+        {
+            {
+                .x = 2,
+                .y = 1,
+            },
+            {
+                .x = 5,
+                .y = 1,
+            },
+        },
+};
+
+static const AtlasDefinition skull_frames = {
+    .width = 16,
+    .height = 16,
+    .pieces_count = 2,
+    .offset_height = 0,
+    .offset_width = 0,
+    .pieces = {{
+                   .x = 0,
+                   .y = 2,
+               },
+               {
+                   .x = 1,
+                   .y = 2,
+               }},
+};
+
+static const AtlasDefinition skull_bullet_frames = {
+    .width = 16,
+    .height = 16,
+    .pieces_count = 1,
+    .offset_width = 0,
+    .offset_height = 0,
+    .pieces =
+        {
+            {
+                .x = 2,
+                .y = 2,
+            },
+        },
+};
+
+static const AtlasDefinition regular_frames = {
+    .width = 16,
+    .height = 16,
+    .pieces_count = 2,
+    .offset_height = 0,
+    .offset_width = 0,
+    .pieces = {{
+                   .x = 0,
+                   .y = 0,
+               },
+               {
+                   .x = 1,
+                   .y = 0,
+               }},
+};
+
+static const AtlasDefinition regular_bullet_frames = {
+    .width = 16,
+    .height = 16,
+    .pieces_count = 1,
+    .offset_width = 0,
+    .offset_height = 0,
+    .pieces =
+        {
+            {
+                .x = 2,
+                .y = 0,
+            },
+        },
+};
+
+static const AtlasDefinition player_frames = {
+    .width = 16,
+    .height = 16,
+    .offset_height = 0,
+    .offset_width = 0,
+    .pieces_count = 1,
+    .pieces = {{
+        .x = 4,
+        .y = 0,
+    }},
+};
+
+static const AtlasDefinition player_bullet_atlas = {
+    .width = 16,
+    .height = 16,
+    .offset_width = 0,
+    .offset_height = 0,
+    .pieces_count = 1,
+    .pieces =
+        {
+            {
+                .x = 2,
+                .y = 0,
+            },
+        },
+};
+
+static const AtlasDefinition destroyable_frames = {
+    .width = 32,
+    .height = 16,
+    .offset_width = 16 * 3,
+    .offset_height = 16,
+    .pieces_count = 4,
+    .pieces = {{
+                   .x = 0,
+                   .y = 0,
+               },
+               {
+                   .x = 0,
+                   .y = 1,
+               },
+               {
+                   .x = 0,
+                   .y = 2,
+               },
+               {
+                   .x = 0,
+                   .y = 3,
+               }},
+};
+
+static const AtlasDefinition destroy_explosion_frames = {
+    .width = 16,
+    .height = 16,
+    .offset_width = 0,
+    .offset_height = 0,
+    .pieces_count = 2,
+    .pieces = {{
+                   .x = 2,
+                   .y = 3,
+               },
+               {
+                   .x = 2,
+                   .y = 4,
+               }},
+};
+
+static const AtlasDefinition *atlases[ATLAS_COUNT] = {
+    [ATLAS_SQUID] = &squid_frames,
+    [ATLAS_SQUID_BULLET] = &squid_bullet_frames,
+    [ATLAS_SKULL] = &skull_frames,
+    [ATLAS_SKULL_BULLET] = &skull_bullet_frames,
+    [ATLAS_REGULAR] = &regular_frames,
+    [ATLAS_REGULAR_BULLET] = &regular_bullet_frames,
+    [ATLAS_PLAYER] = &player_frames,
+    [ATLAS_PLAYER_BULLET] = &player_bullet_atlas,
+    [ATLAS_DESTROYABLE] = &destroyable_frames,
+    [ATLAS_DESTROY_EXPLOSION] = &destroy_explosion_frames,
+};
+
+const AtlasDefinition *atlas_definition(AtlasId id)
+{
+    return id < ATLAS_COUNT ? atlases[id] : NULL;
+}
+
+static const EnemyTypes enemy_types = {
+    .enemy_regular =
+        {
+            .atlas = ATLAS_REGULAR,
+            .bullet_atlas = ATLAS_REGULAR_BULLET,
+        },
+    .enemy_squid =
+        {
+            .atlas = ATLAS_SQUID,
+            .bullet_atlas = ATLAS_SQUID_BULLET,
+        },
+    .enemy_skull =
+        {
+            .atlas = ATLAS_SKULL,
+            .bullet_atlas = ATLAS_SKULL_BULLET,
+        },
+    .enemy_head =
+        {
+            .atlas = ATLAS_REGULAR,
+            .bullet_atlas = ATLAS_REGULAR_BULLET,
+        },
+    .enemy_horns =
+        {
+            .atlas = ATLAS_SQUID,
+            .bullet_atlas = ATLAS_SQUID_BULLET,
+        },
+};
+
+// What every table holds and how many rows it has room for. The player has a table of their own, with a single row.
+#define MOVING_SPRITE (HAS(POSITION) | HAS(PREVIOUS_POSITION) | HAS(ANIMATOR))
+
+static const struct
+{
+    ComponentMask components;
+    size_t capacity;
+} table_layouts[TABLE_COUNT] = {
+    [TABLE_SHIELDS] = {HAS(POSITION) | HAS(ANIMATOR) | HAS(HEALTH), MAX_DESTROYABLES},
+    [TABLE_ENEMIES] = {HAS(ANIMATOR) | HAS(HEALTH) | HAS(SLOT) | HAS(FIRE_INTERVAL) | HAS(FIRE_NEXT) |
+                           HAS(BULLET_ATLAS),
+                       MAX_ENEMIES},
+    [TABLE_ENEMY_BULLETS] = {MOVING_SPRITE | HAS(TIMING), MAX_ENEMY_BULLETS},
+    [TABLE_PARTICLES] = {MOVING_SPRITE, MAX_PARTICLES},
+    [TABLE_PLAYER] = {MOVING_SPRITE | HAS(TIMING) | HAS(HEALTH), 1},
+    [TABLE_PLAYER_BULLET] = {MOVING_SPRITE, 1},
+};
+
+void game_world_init(World *world)
+{
+    static const uint16_t sizes[COMPONENT_COUNT] = {
+#define X(id, type, name) [COMPONENT_##id] = sizeof(type),
+        GAME_COMPONENTS(X)
+#undef X
+    };
+    world_init(world, sizes, COMPONENT_COUNT);
+    for (size_t table = 0; table < TABLE_COUNT; ++table)
+    {
+        world_add_table(world, table_layouts[table].components, table_layouts[table].capacity);
+    }
+}
+
+Vector2 game_table_size(size_t table)
+{
+    switch (table)
+    {
+    case TABLE_SHIELDS:
+        return DESTROYABLE_SIZE;
+
+    case TABLE_ENEMIES:
+    case TABLE_PARTICLES:
+        return ENEMY_SIZE;
+
+    case TABLE_ENEMY_BULLETS:
+    case TABLE_PLAYER_BULLET:
+        return BULLET_SIZE;
+
+    case TABLE_PLAYER:
+        return PLAYER_SIZE;
+
+    default:
+        NOB_UNREACHABLE("Table was bad?\n");
+    }
+}
+
+// Bit i is set when column i has a live enemy in any row.
+static uint64_t live_columns(const Formation *formation)
+{
+    uint64_t columns = 0;
+    for (size_t row = 0; row < ENEMY_ROWS; ++row)
+    {
+        columns |= formation->alive[row];
+    }
+    return columns;
+}
+
+// The lowest row with a live enemy, or -1 when there is none.
+static int lowest_live_row(const Formation *formation)
+{
+    for (int row = ENEMY_ROWS - 1; row >= 0; --row)
+    {
+        if (formation->alive[row] != 0)
+        {
+            return row;
+        }
+    }
+    return -1;
+}
+
+static bool all_enemies_defeated(const State *state)
+{
+    return live_columns(&state->formation) == 0;
+}
+
+size_t enemies_alive(const State *state)
+{
+    size_t alive = 0;
+    for (size_t row = 0; row < ENEMY_ROWS; ++row)
+    {
+        alive += __builtin_popcountll(state->formation.alive[row]);
+    }
+    return alive;
+}
+
+Vector2 enemy_position(const Formation *formation, size_t slot)
+{
+    return (Vector2){
+        .x = formation->origin.x + slot % COLUMNS,
+        .y = formation->origin.y + slot / COLUMNS,
+    };
+}
+
+Vector2 enemy_previous_position(const Formation *formation, size_t slot)
+{
+    return (Vector2){
+        .x = formation->previous_origin.x + slot % COLUMNS,
+        .y = formation->previous_origin.y + slot / COLUMNS,
+    };
+}
+
+// The row in TABLE_ENEMIES of the enemy filling a live slot.
+static size_t enemy_row(const State *state, size_t slot)
+{
+    size_t row = 0;
+    if (!world_find_in(&state->world, state->formation.members[slot], TABLE_ENEMIES, &row))
+    {
+        NOB_UNREACHABLE("A live slot had no enemy?\n");
+    }
+    return row;
+}
+
+size_t destroyable_frame(uint8_t health)
+{
+    if (health > DESTROYABLE_SECOND_HEALTH)
+    {
+        return 0;
+    }
+    if (health > DESTROYABLE_THIRD_HEALTH)
+    {
+        return 1;
+    }
+    if (health > DESTROYABLE_FOURTH_HEALTH)
+    {
+        return 2;
+    }
+    return 3;
+}
+
+// Whole frames shown since the animation started, which keeps counting past the last one.
+static uint64_t animator_steps(const Animator *animator, uint64_t animation_ns)
+{
+    return (animation_ns - animator->phase_ns) / ANIMATION_FRAME_NS;
+}
+
+size_t animator_frame(const Animator *animator, uint64_t animation_ns)
+{
+    return animator_steps(animator, animation_ns) % atlas_definition(animator->atlas)->pieces_count;
+}
+
+// Shields never move, so they sit in a broadphase grid with a cell per world unit. A shield is 1.5 x .5 units, so it
+// spans at most 3 x 2 cells. The formation and the player move, and are looked up directly instead.
+#define TARGET_CELLS (COLUMNS * GAME_ROWS)
+#define MAX_TARGET_ITEMS (6 * MAX_DESTROYABLES)
+
+typedef struct
+{
+    CollisionGrid grid;
+    uint32_t cell_start[TARGET_CELLS + 1];
+    uint32_t index[MAX_TARGET_ITEMS];
+    float item_storage[4 * MAX_TARGET_ITEMS];
+    // The shield each box was built from. A shield that dies mid-tick leaves its box empty, while despawning it moves
+    // another shield into its row, so boxes name shields by handle.
+    Handle shields[MAX_DESTROYABLES];
+    size_t shields_count;
+} Targets;
+
+static Rectangle box_at(Vector2 position, Vector2 size)
+{
+    return (Rectangle){
+        .width = size.x,
+        .height = size.y,
+        .x = position.x,
+        .y = position.y,
+    };
+}
+
+static void take_damage(uint8_t *health, uint8_t damage)
+{
+    *health = *health > damage ? *health - damage : 0;
+}
+
+// Slot `column` of a row spans [origin.x + column, origin.x + column + ENEMY_SIZE.x], so only the columns strictly
+// between the formation-local `min` - `size` and `max` can overlap, at most two for a bullet. Widened by one each way
+// before the exact test, so rounding in the local coordinate can never drop a slot.
+static void lattice_span(float min, float max, float size, size_t count, size_t *first, size_t *last)
+{
+    float low = floorf(min - size) - 1;
+    float high = floorf(max) + 1;
+    *first = low > 0 ? (size_t)low : 0;
+    *last = high < count - 1 ? (size_t)(high > 0 ? high : 0) : count - 1;
+}
+
+// The live slot that `box`, at its position at the start of the tick and moving by `motion` over it, hits earliest,
+// lowest slot on ties, or -1. The formation moves too, so the sweep runs in its frame: from where the slots were, by
+// the motion of the box relative to them. Only the few slots along the path are tested, whatever the formation size.
+static int formation_first_sweep(const Formation *formation, Rectangle box, Vector2 motion, float *time)
+{
+    Vector2 relative = Vector2Subtract(motion, Vector2Subtract(formation->origin, formation->previous_origin));
+    float min_x = box.x - formation->previous_origin.x;
+    float min_y = box.y - formation->previous_origin.y;
+    float max_x = min_x + box.width;
+    float max_y = min_y + box.height;
+
+    size_t first_column, last_column, first_row, last_row;
+    lattice_span(fminf(min_x, min_x + relative.x), fmaxf(max_x, max_x + relative.x), ENEMY_SIZE.x, COLUMNS,
+                 &first_column, &last_column);
+    lattice_span(fminf(min_y, min_y + relative.y), fmaxf(max_y, max_y + relative.y), ENEMY_SIZE.y, ENEMY_ROWS,
+                 &first_row, &last_row);
+
+    int best = -1;
+    for (size_t row = first_row; row <= last_row; ++row)
+    {
+        for (size_t column = first_column; column <= last_column; ++column)
+        {
+            size_t slot = row * COLUMNS + column;
+            if (!(formation->alive[row] & (1ull << column)))
+            {
+                continue;
+            }
+
+            float t = collision_sweep(box, relative, box_at(enemy_previous_position(formation, slot), ENEMY_SIZE));
+            if (t >= 0 && (best < 0 || t < *time))
+            {
+                best = slot;
+                *time = t;
+            }
+        }
+    }
+    return best;
+}
+
+// Rebuilt once per tick after everything has moved, so each bullet only tests the targets in the cells it overlaps.
+static void build_targets(Targets *targets, const State *state)
+{
+    const World *world = &state->world;
+    float storage[4 * MAX_DESTROYABLES];
+    CollisionBoxes boxes;
+    collision_boxes_init(&boxes, storage, MAX_DESTROYABLES);
+    targets->shields_count = world->tables[TABLE_SHIELDS].count;
+    for (size_t c = 0; c < world_chunks_count(world, TABLE_SHIELDS); ++c)
+    {
+        EntityChunk chunk = entity_table_chunk(world, TABLE_SHIELDS, c);
+        for (size_t i = 0; i < chunk.count; ++i)
+        {
+            collision_boxes_push(&boxes, box_at(chunk.position[i], DESTROYABLE_SIZE));
+            targets->shields[chunk.first + i] = world_handle(world, TABLE_SHIELDS, chunk.first + i);
+        }
+    }
+
+    collision_grid_init(&targets->grid, (Vector2){0}, 1, COLUMNS, GAME_ROWS, targets->cell_start, targets->index,
+                        targets->item_storage, MAX_TARGET_ITEMS);
+    if (!collision_grid_build(&targets->grid, &boxes))
+    {
+        NOB_UNREACHABLE("Targets outgrew the broadphase\n");
+    }
+}
+
+static void damage_destroyable(State *state, Targets *targets, size_t row)
+{
+    World *world = &state->world;
+    uint8_t *health = entity_health(world, TABLE_SHIELDS, row);
+    take_damage(health, state->config.bullet_damage);
+    if (*health > 0)
+    {
+        return;
+    }
+
+    Handle shield = world_handle(world, TABLE_SHIELDS, row);
+    for (size_t box = 0; box < targets->shields_count; ++box)
+    {
+        if (targets->shields[box] == shield)
+        {
+            collision_grid_remove(&targets->grid, box,
+                                  box_at(*entity_position(world, TABLE_SHIELDS, row), DESTROYABLE_SIZE));
+        }
+    }
+    world_despawn_row(world, TABLE_SHIELDS, row);
+}
+
+// Their ring is a single run of rows, so ticking reads its age order straight off one chunk.
+_Static_assert(MAX_PARTICLES <= ARCHETYPE_CHUNK_ROWS, "particles fit one chunk");
+
+// Appends behind the newest particle, replacing the oldest in place when the table is full. No other particle moves.
+static void spawn_particle(State *state, Animator animator, Vector2 position)
+{
+    World *world = &state->world;
+    const Archetype *particles = &world->tables[TABLE_PARTICLES];
+    size_t row = particles->count;
+    if (row == particles->capacity)
+    {
+        row = state->oldest_particle;
+        world_replace_row(world, TABLE_PARTICLES, row);
+        state->oldest_particle = (row + 1) % particles->capacity;
+    }
+    else if (world_spawn(world, TABLE_PARTICLES, 1, NULL) == 0)
+    {
+        return;
+    }
+
+    *entity_animator(world, TABLE_PARTICLES, row) = animator;
+    *entity_position(world, TABLE_PARTICLES, row) = position;
+    *entity_previous_position(world, TABLE_PARTICLES, row) = position;
+}
+
+static void hit_enemy(State *state, size_t row)
+{
+    World *world = &state->world;
+    Formation *formation = &state->formation;
+    size_t slot = *entity_slot(world, TABLE_ENEMIES, row);
+    uint8_t *health = entity_health(world, TABLE_ENEMIES, row);
+    take_damage(health, state->config.bullet_damage);
+    if (*health <= 0)
+    {
+        formation->alive[slot / COLUMNS] &= ~(1ull << (slot % COLUMNS));
+        formation->members[slot] = HANDLE_NONE;
+        timer_wheel_cancel(&state->timers.wheel, state->timers.nodes, slot);
+        world_despawn_row(world, TABLE_ENEMIES, row);
+    }
+
+    state->score += 10;
+    Animator explosion = {
+        .atlas = ATLAS_DESTROY_EXPLOSION,
+        .phase_ns = state->animation_ns,
+    };
+    spawn_particle(state, explosion, enemy_position(formation, slot));
+
+    if (all_enemies_defeated(state))
+    {
+        state->status = WON;
+    }
+}
+
+// Spawns a bullet falling from `position`. A full table drops it rather than growing mid-frame.
+static void spawn_enemy_bullet(World *world, Animator animator, Vector2 position)
+{
+    size_t row = world->tables[TABLE_ENEMY_BULLETS].count;
+    if (world_spawn(world, TABLE_ENEMY_BULLETS, 1, NULL) == 1)
+    {
+        *entity_animator(world, TABLE_ENEMY_BULLETS, row) = animator;
+        *entity_position(world, TABLE_ENEMY_BULLETS, row) = position;
+        *entity_previous_position(world, TABLE_ENEMY_BULLETS, row) = position;
+        *entity_timing(world, TABLE_ENEMY_BULLETS, row) = (Accumulator){
+            .ns_accumulated = 0,
+            .ns_to_trigger = 200 * ACCUMULATOR_NS_PER_MS,
+        };
+    }
+}
+
+static void push_event(GameEvents *events, GameEvent event)
+{
+    if (events->count < MAX_EVENTS)
+    {
+        events->items[events->count++] = event;
+    }
+}
+
+static GameEvent make_event(GameEventKind kind, Handle target, Handle bullet)
+{
+    return (GameEvent){.kind = kind, .target = target, .bullet = bullet};
+}
+
+// Detection of the player's bullet against the formation, the shields and the top of the world. Reads the state only,
+// and returns false when the bullet carries on.
+static bool detect_player_bullet(const State *state, const Targets *targets, GameEvent *event)
+{
+    const World *world = &state->world;
+    if (world->tables[TABLE_PLAYER_BULLET].count == 0)
+    {
+        return false;
+    }
+
+    Handle bullet = world_handle(world, TABLE_PLAYER_BULLET, 0);
+    Vector2 position = *entity_position(world, TABLE_PLAYER_BULLET, 0);
+    Vector2 previous_position = *entity_previous_position(world, TABLE_PLAYER_BULLET, 0);
+
+    // Swept from where the bullet started the tick, so a long tick can not carry it through a target.
+    Rectangle bullet_box = box_at(previous_position, BULLET_SIZE);
+    Vector2 motion = Vector2Subtract(position, previous_position);
+
+    float enemy_time = 0;
+    int enemy = formation_first_sweep(&state->formation, bullet_box, motion, &enemy_time);
+    float shield_time = 0;
+    int shield =
+        collision_grid_first_sweep(&targets->grid, bullet_box, motion, 0, targets->shields_count, &shield_time);
+
+    // The formation wins ties, as it always took priority over the shields.
+    if (enemy >= 0 && (shield < 0 || enemy_time <= shield_time))
+    {
+        *event = make_event(EVENT_ENEMY_HIT, state->formation.members[enemy], bullet);
+        return true;
+    }
+    if (shield >= 0)
+    {
+        *event = make_event(EVENT_SHIELD_HIT, targets->shields[shield], bullet);
+        return true;
+    }
+    if (position.y <= 0)
+    {
+        *event = make_event(EVENT_BULLET_GONE, HANDLE_NONE, bullet);
+        return true;
+    }
+    return false;
+}
+
+// The player as enemy bullets see them. Only resolving a hit changes it, so a pass over the bullets looks it up once.
+typedef struct
+{
+    Handle handle;
+    bool alive;
+    Vector2 position;
+    Vector2 previous_position;
+} PlayerTarget;
+
+static PlayerTarget player_target(const World *world)
+{
+    return (PlayerTarget){
+        .handle = world_handle(world, TABLE_PLAYER, 0),
+        .alive = *entity_health(world, TABLE_PLAYER, 0) > 0,
+        .position = *entity_position(world, TABLE_PLAYER, 0),
+        .previous_position = *entity_previous_position(world, TABLE_PLAYER, 0),
+    };
+}
+
+// Detection of one enemy bullet against the shields and the player. Reads the state only, and returns false when the
+// bullet carries on.
+static bool detect_enemy_bullet(const Targets *targets, const PlayerTarget *player, Handle bullet, Vector2 position,
+                                Vector2 previous_position, GameEvent *event)
+{
+    // Swept from where the bullet started the tick, so a long tick can not carry it through a target.
+    Rectangle bullet_box = box_at(previous_position, BULLET_SIZE);
+    Vector2 motion = Vector2Subtract(position, previous_position);
+
+    float shield_time = 0;
+    int shield =
+        collision_grid_first_sweep(&targets->grid, bullet_box, motion, 0, targets->shields_count, &shield_time);
+
+    // The player moves during the tick too, so their sweep is relative to them. Shields win ties.
+    float player_time = -1;
+    if (player->alive)
+    {
+        Vector2 player_motion = Vector2Subtract(player->position, player->previous_position);
+        player_time = collision_sweep(bullet_box, Vector2Subtract(motion, player_motion),
+                                      box_at(player->previous_position, PLAYER_SIZE));
+    }
+
+    if (player_time >= 0 && (shield < 0 || player_time < shield_time))
+    {
+        *event = make_event(EVENT_PLAYER_HIT, player->handle, bullet);
+        return true;
+    }
+    if (shield >= 0)
+    {
+        *event = make_event(EVENT_SHIELD_HIT, targets->shields[shield], bullet);
+        return true;
+    }
+    if (position.y > GAME_ROWS)
+    {
+        *event = make_event(EVENT_BULLET_GONE, HANDLE_NONE, bullet);
+        return true;
+    }
+    return false;
+}
+
+// Detection of a bullet that is still in play, found by the handle its events carry.
+static bool detect_bullet(const State *state, const Targets *targets, Handle bullet, GameEvent *event)
+{
+    size_t table = 0;
+    size_t row = 0;
+    if (!world_find(&state->world, bullet, &table, &row))
+    {
+        return false;
+    }
+
+    switch (table)
+    {
+    case TABLE_PLAYER_BULLET:
+        return detect_player_bullet(state, targets, event);
+
+    case TABLE_ENEMY_BULLETS:
+    {
+        const World *world = &state->world;
+        PlayerTarget player = player_target(world);
+        return detect_enemy_bullet(targets, &player, bullet, *entity_position(world, TABLE_ENEMY_BULLETS, row),
+                                   *entity_previous_position(world, TABLE_ENEMY_BULLETS, row), event);
+    }
+
+    default:
+        return false;
+    }
+}
+
+// Finds the row of what an event hit. Fails once it is gone, and succeeds for events that hit nothing.
+static bool find_target(const State *state, const GameEvent *event, size_t *row)
+{
+    *row = 0;
+    switch (event->kind)
+    {
+    case EVENT_ENEMY_HIT:
+        return world_find_in(&state->world, event->target, TABLE_ENEMIES, row);
+
+    case EVENT_SHIELD_HIT:
+        return world_find_in(&state->world, event->target, TABLE_SHIELDS, row);
+
+    case EVENT_PLAYER_HIT:
+        return world_find_in(&state->world, event->target, TABLE_PLAYER, row);
+
+    default:
+        return true;
+    }
+}
+
+// Applies the events detected since `first`, in order, and despawns the bullets they used up. Events name bullets and
+// targets by handle, so despawning may move the others around in any order.
+// A hit on a target an earlier event of the tick destroyed did not happen. The dead target is already out of the grid,
+// so the bullet is detected again against what is left and the new outcome takes the event's place, or the event is
+// dropped when the bullet now carries on. Detection stops at the first hit on the player, so does detecting again.
+static void resolve_events(State *state, Targets *targets, size_t first)
+{
+    GameEvents *events = &state->events;
+    size_t kept = first;
+    bool player_hit = false;
+    for (size_t i = first; i < events->count; ++i)
+    {
+        GameEvent event = events->items[i];
+        size_t target = 0;
+        bool happened = true;
+        while (happened && !find_target(state, &event, &target))
+        {
+            happened = detect_bullet(state, targets, event.bullet, &event);
+            happened = happened && !(player_hit && event.kind == EVENT_PLAYER_HIT);
+        }
+        if (!happened)
+        {
+            continue;
+        }
+
+        switch (event.kind)
+        {
+        case EVENT_ENEMY_HIT:
+            hit_enemy(state, target);
+            break;
+
+        case EVENT_SHIELD_HIT:
+            damage_destroyable(state, targets, target);
+            break;
+
+        case EVENT_PLAYER_HIT:
+            take_damage(entity_health(&state->world, TABLE_PLAYER, target), state->config.bullet_damage);
+            state->status = LOST;
+            player_hit = true;
+            break;
+
+        case EVENT_BULLET_GONE:
+            break;
+
+        default:
+            NOB_UNREACHABLE("Event had a bad kind?\n");
+            break;
+        }
+
+        world_despawn(&state->world, event.bullet);
+        events->items[kept++] = event;
+    }
+    events->count = kept;
+}
+
+GameConfig game_default_config(void)
+{
+    return (GameConfig){
+        .fire_timer_min_ms = 5000,
+        .fire_timer_max_ms = 30000,
+        .enemy_speed = 0.1f,
+        .bullet_damage = BULLET_DAMAGE,
+    };
+}
+
+void game_init(State *state, const GameConfig *config, uint64_t seed)
+{
+    // Zero everything, padding included, so snapshots of equal states are equal byte for byte.
+    memset(state, 0, sizeof(*state));
+    state->config = *config;
+    state->status = WAITING;
+    rng_seed(&state->rng, seed);
+    game_world_init(&state->world);
+    setup(state);
+}
+
+void setup(State *state)
+{
+    World *world = &state->world;
+    // Despawned rather than forgotten, so handles from the last round stop matching.
+    for (size_t table = 0; table < TABLE_COUNT; ++table)
+    {
+        world_clear(world, table);
+    }
+    state->oldest_particle = 0;
+
+    Formation *formation = &state->formation;
+    formation->origin = (Vector2){0};
+    formation->previous_origin = (Vector2){0};
+    formation->going_right = true;
+    formation->fire_scheduled = false;
+    memset(formation->alive, 0, sizeof(formation->alive));
+
+    Vector2 start = {
+        .x = COLUMNS / 2,
+        .y = GAME_ROWS - 1,
+    };
+    world_spawn(world, TABLE_PLAYER, 1, NULL);
+    *entity_position(world, TABLE_PLAYER, 0) = start;
+    *entity_previous_position(world, TABLE_PLAYER, 0) = start;
+    *entity_timing(world, TABLE_PLAYER, 0) = (Accumulator){
+        .ns_accumulated = 0,
+        .ns_to_trigger = 200 * ACCUMULATOR_NS_PER_MS,
+    };
+    *entity_animator(world, TABLE_PLAYER, 0) = (Animator){.atlas = ATLAS_PLAYER};
+    *entity_health(world, TABLE_PLAYER, 0) = PLAYER_FULL_HEALTH;
+
+    state->time_to_accept_input = (Accumulator){
+        .ns_accumulated = 0,
+        .ns_to_trigger = 1000 * ACCUMULATOR_NS_PER_MS,
+    };
+
+    state->score = 0;
+    state->animation_ns = 0;
+
+    timer_wheel_init(&state->timers.wheel, state->timers.nodes, MAX_TIMERS);
+    state->timers.now_ns = 0;
+
+    // Spawned in slot order, so row i fills slot i until enemies start dying.
+    world_spawn(world, TABLE_ENEMIES, MAX_ENEMIES, formation->members);
+    for (size_t i = 0; i < COLUMNS; ++i)
+    {
+        for (size_t j = 0; j < ENEMY_ROWS; ++j)
+        {
+            EnemyTypeInfo info = (j == 0 || j == 1) ? enemy_types.enemy_squid : enemy_types.enemy_regular;
+
+            size_t index = j * COLUMNS + i;
+            formation->alive[j] |= 1ull << i;
+            *entity_slot(world, TABLE_ENEMIES, index) = index;
+            *entity_health(world, TABLE_ENEMIES, index) = ENEMY_FULL_HEALTH;
+            *entity_fire_interval_ms(world, TABLE_ENEMIES, index) =
+                rng_range(&state->rng, state->config.fire_timer_min_ms, state->config.fire_timer_max_ms);
+            *entity_animator(world, TABLE_ENEMIES, index) = (Animator){.atlas = info.atlas};
+            *entity_bullet_atlas(world, TABLE_ENEMIES, index) = info.bullet_atlas;
+        }
+    }
+
+    world_spawn(world, TABLE_SHIELDS, MAX_DESTROYABLES, NULL);
+    for (size_t i = 0; i < MAX_DESTROYABLES; ++i)
+    {
+        *entity_position(world, TABLE_SHIELDS, i) = (Vector2){
+            .x = (i + 1) * 2,
+            .y = ENEMY_ROWS + 2,
+        };
+        *entity_animator(world, TABLE_SHIELDS, i) = (Animator){.atlas = ATLAS_DESTROYABLE};
+        *entity_health(world, TABLE_SHIELDS, i) = DESTROYABLE_FULL_HEALTH;
+    }
+}
+
+static bool move_player(Vector2 *position, uint8_t input, float dt)
+{
+    Vector2 next_direction = {0};
+
+    if (input & INPUT_RIGHT)
+    {
+        next_direction.x += dt;
+    }
+    else if (input & INPUT_LEFT)
+    {
+        next_direction.x -= dt;
+    }
+
+    Vector2 new_position = Vector2Add(next_direction, *position);
+
+    if (new_position.x <= 0)
+    {
+        new_position.x = 0;
+    }
+    else if (new_position.x >= COLUMNS)
+    {
+        new_position.x = COLUMNS;
+    }
+
+    *position = new_position;
+    return next_direction.x != 0.0;
+}
+
+// Schedules the next shot of slot `id` on the tick an Accumulator of its interval would trigger: the first one that
+// ends at or after `fire_next_ns`, or the next one when that already passed.
+static void schedule_fire(Timers *timers, uint64_t fire_next_ns, uint16_t id, uint64_t dt_ns)
+{
+    uint64_t ahead = fire_next_ns > timers->now_ns ? fire_next_ns - timers->now_ns : 0;
+    uint64_t ticks = ahead > 0 ? (ahead + dt_ns - 1) / dt_ns : 1;
+    timer_wheel_schedule(&timers->wheel, timers->nodes, id, timers->wheel.now + ticks, TIMER_ENEMY_FIRE);
+}
+
+// Advances the wheel by one playing tick and marks the slots whose timers went off, rescheduling them.
+static void due_fire_timers(State *state, uint64_t dt_ns, uint64_t firing[ENEMY_ROWS])
+{
+    Timers *timers = &state->timers;
+    Formation *formation = &state->formation;
+    World *world = &state->world;
+    memset(firing, 0, ENEMY_ROWS * sizeof(*firing));
+
+    // Time that does not pass never adds up to a shot, like with an Accumulator.
+    if (dt_ns == 0)
+    {
+        return;
+    }
+
+    if (!formation->fire_scheduled)
+    {
+        for (size_t i = enemies_next_alive(formation, 0); i < MAX_ENEMIES; i = enemies_next_alive(formation, i + 1))
+        {
+            size_t row = enemy_row(state, i);
+            uint64_t *fire_next_ns = entity_fire_next_ns(world, TABLE_ENEMIES, row);
+            uint64_t interval_ns = *entity_fire_interval_ms(world, TABLE_ENEMIES, row) * ACCUMULATOR_NS_PER_MS;
+            *fire_next_ns = timers->now_ns + interval_ns;
+            schedule_fire(timers, *fire_next_ns, i, dt_ns);
+        }
+        formation->fire_scheduled = true;
+    }
+
+    timer_wheel_advance(&timers->wheel, timers->nodes);
+    timers->now_ns += dt_ns;
+    for (uint16_t id; (id = timer_wheel_pop(&timers->wheel, timers->nodes)) != TIMER_NONE;)
+    {
+        switch (timers->nodes[id].tag)
+        {
+        case TIMER_ENEMY_FIRE:
+        {
+            size_t row = enemy_row(state, id);
+            uint64_t *fire_next_ns = entity_fire_next_ns(world, TABLE_ENEMIES, row);
+            firing[id / COLUMNS] |= 1ull << (id % COLUMNS);
+            *fire_next_ns += *entity_fire_interval_ms(world, TABLE_ENEMIES, row) * ACCUMULATOR_NS_PER_MS;
+            schedule_fire(timers, *fire_next_ns, id, dt_ns);
+            break;
+        }
+
+        default:
+            NOB_UNREACHABLE("Timer had a bad tag?\n");
+            break;
+        }
+    }
+}
+
+static void handle_player_shooting(World *world, uint8_t input, uint64_t dt_ns)
+{
+    Accumulator *shooting = entity_timing(world, TABLE_PLAYER, 0);
+    if ((input & INPUT_SHOOT) && accumulator_tick(shooting, dt_ns, When_Tick_Ends_Keep) &&
+        world->tables[TABLE_PLAYER_BULLET].count == 0)
+    {
+        shooting->ns_accumulated = 0;
+        Vector2 player = *entity_position(world, TABLE_PLAYER, 0);
+        Vector2 muzzle = {
+            .x = player.x + PLAYER_SIZE.x / 2,
+            .y = player.y,
+        };
+        world_spawn(world, TABLE_PLAYER_BULLET, 1, NULL);
+        *entity_position(world, TABLE_PLAYER_BULLET, 0) = muzzle;
+        *entity_previous_position(world, TABLE_PLAYER_BULLET, 0) = muzzle;
+        *entity_animator(world, TABLE_PLAYER_BULLET, 0) = (Animator){.atlas = ATLAS_PLAYER_BULLET};
+    }
+}
+
+// What the jobs of a playing tick share besides the State.
+typedef struct
+{
+    State *state;
+    uint8_t input;
+    float dt;
+    uint64_t dt_ns;
+    // Whether the round was under way when the tick started, which is when animations run.
+    bool was_playing;
+    // Whether it is under way once the player moved, which is when everything else runs.
+    bool playing;
+    uint64_t firing[ENEMY_ROWS];
+    Targets targets;
+} Tick;
+
+// The parts of a tick the jobs declare reading and writing, so jobs that touch disjoint parts can share a wave.
+typedef enum
+{
+    PART_STATUS = 1 << 0,
+    PART_TICK_PLAYING = 1 << 1,
+    PART_ANIMATION = 1 << 2,
+    PART_PARTICLES = 1 << 3,
+    // Where the player is and their health.
+    PART_PLAYER = 1 << 4,
+    // The player's bullet and how long until they can shoot again.
+    PART_PLAYER_BULLET = 1 << 5,
+    // Origin and direction of the formation.
+    PART_FORMATION = 1 << 6,
+    // Which slots are alive, and the rows of the enemies filling them but for their fire schedule.
+    PART_ENEMY_SLOTS = 1 << 7,
+    // Fire timers, with the schedule they keep in the rows of the enemies.
+    PART_ENEMY_FIRE = 1 << 8,
+    PART_ENEMY_BULLETS = 1 << 9,
+    PART_DESTROYABLES = 1 << 10,
+    PART_TARGETS = 1 << 11,
+    PART_SCORE = 1 << 12,
+    PART_EVENTS = 1 << 13,
+    // Which entities exist and where their rows are. Spawning and despawning write it, finding by handle reads it.
+    PART_ENTITIES = 1 << 14,
+} TickPart;
+
+static void animate(void *context)
+{
+    Tick *tick = context;
+    State *state = tick->state;
+    if (!tick->was_playing)
+    {
+        return;
+    }
+
+    state->animation_ns += tick->dt_ns;
+
+    // Particles all play the same explosion once, so the finished ones are the oldest. Rotating the table puts them
+    // behind the others, still in age order from row 0, and despawning them from the last row moves nothing else.
+    World *world = &state->world;
+    EntityChunk particles = entity_table_chunk(world, TABLE_PARTICLES, 0);
+    size_t finished = 0;
+    for (; finished < particles.count; ++finished)
+    {
+        const Animator *animator = &particles.animator[(state->oldest_particle + finished) % particles.count];
+        if (animator_steps(animator, state->animation_ns) < atlas_definition(animator->atlas)->pieces_count)
+        {
+            break;
+        }
+    }
+    if (finished > 0)
+    {
+        world_rotate(world, TABLE_PARTICLES, (state->oldest_particle + finished) % particles.count);
+        state->oldest_particle = 0;
+        for (; finished > 0; --finished)
+        {
+            world_despawn_row(world, TABLE_PARTICLES, world->tables[TABLE_PARTICLES].count - 1);
+        }
+    }
+}
+
+static void steer_player(void *context)
+{
+    Tick *tick = context;
+    State *state = tick->state;
+
+    bool moved = move_player(entity_position(&state->world, TABLE_PLAYER, 0), tick->input, tick->dt);
+    if (moved && state->status == WAITING)
+    {
+        state->status = PLAYING;
+    }
+    tick->playing = state->status == PLAYING;
+}
+
+static void prepare_targets(void *context)
+{
+    Tick *tick = context;
+    build_targets(&tick->targets, tick->state);
+}
+
+static void shoot(void *context)
+{
+    Tick *tick = context;
+    if (tick->playing)
+    {
+        handle_player_shooting(&tick->state->world, tick->input, tick->dt_ns);
+    }
+}
+
+// The whole formation moves at once, and only its live extremes can touch a wall or the game over row.
+static void move_formation(void *context)
+{
+    Tick *tick = context;
+    State *state = tick->state;
+    Formation *formation = &state->formation;
+    uint64_t columns = live_columns(formation);
+    if (!tick->playing || columns == 0)
+    {
+        return;
+    }
+
+    float enemy_speed = state->config.enemy_speed * tick->dt;
+    float step = formation->going_right ? enemy_speed : -enemy_speed;
+
+    int min_column = __builtin_ctzll(columns);
+    int max_column = 63 - __builtin_clzll(columns);
+    bool reached_wall =
+        formation->origin.x + min_column + step < 0 || formation->origin.x + max_column + step > COLUMNS;
+    if (reached_wall)
+    {
+        formation->going_right = !formation->going_right;
+        step = -step;
+    }
+
+    formation->origin.x += step;
+    formation->origin.y += reached_wall ? 0.05f : 0.0f;
+
+    if (formation->origin.y + lowest_live_row(formation) >= ENEMIES_GAME_OVER_ROW)
+    {
+        state->status = LOST;
+    }
+}
+
+static void fire_enemies(void *context)
+{
+    Tick *tick = context;
+    State *state = tick->state;
+    World *world = &state->world;
+    if (!tick->playing)
+    {
+        return;
+    }
+
+    due_fire_timers(state, tick->dt_ns, tick->firing);
+    // Shots go out in slot order, as they did when every enemy polled its own timer.
+    for (size_t row = 0; row < ENEMY_ROWS; ++row)
+    {
+        for (uint64_t bits = tick->firing[row]; bits != 0; bits &= bits - 1)
+        {
+            size_t i = row * COLUMNS + __builtin_ctzll(bits);
+            Vector2 position = enemy_position(&state->formation, i);
+            Vector2 muzzle = {
+                .x = position.x + ENEMY_SIZE.x / 2,
+                .y = position.y + ENEMY_SIZE.y,
+            };
+            Animator animator = {
+                .atlas = *entity_bullet_atlas(world, TABLE_ENEMIES, enemy_row(state, i)),
+                .phase_ns = state->animation_ns,
+            };
+            spawn_enemy_bullet(world, animator, muzzle);
+        }
+    }
+}
+
+// One pass moves every enemy bullet and detects what it hit, then the hits are resolved together.
+static void move_enemy_bullets(void *context)
+{
+    Tick *tick = context;
+    State *state = tick->state;
+    if (!tick->playing)
+    {
+        return;
+    }
+
+    const Vector2 gravity = {
+        .x = 0,
+        .y = 10 * tick->dt,
+    };
+
+    size_t first = state->events.count;
+    // Once the player is hit the round is over, the remaining bullets only move.
+    bool player_hit = false;
+    World *world = &state->world;
+    PlayerTarget player = player_target(world);
+    for (size_t c = world_chunks_count(world, TABLE_ENEMY_BULLETS); c-- > 0;)
+    {
+        EntityChunk chunk = entity_table_chunk(world, TABLE_ENEMY_BULLETS, c);
+        // The timing column of the chunk in one pass, before anything else about its bullets is looked at.
+        bool falls[ARCHETYPE_CHUNK_ROWS];
+        accumulator_tick_all(chunk.timing, chunk.count, tick->dt_ns, When_Tick_Ends_Restart, falls);
+        for (size_t i = chunk.count; i-- > 0;)
+        {
+            if (falls[i])
+            {
+                chunk.position[i] = Vector2Add(chunk.position[i], gravity);
+            }
+
+            GameEvent event;
+            Handle bullet = world_handle(world, TABLE_ENEMY_BULLETS, chunk.first + i);
+            if (!player_hit && detect_enemy_bullet(&tick->targets, &player, bullet, chunk.position[i],
+                                                   chunk.previous_position[i], &event))
+            {
+                push_event(&state->events, event);
+                player_hit = event.kind == EVENT_PLAYER_HIT;
+            }
+        }
+    }
+
+    resolve_events(state, &tick->targets, first);
+}
+
+static void fly_player_bullet(void *context)
+{
+    Tick *tick = context;
+    State *state = tick->state;
+    if (!tick->playing)
+    {
+        return;
+    }
+
+    if (state->world.tables[TABLE_PLAYER_BULLET].count > 0)
+    {
+        entity_position(&state->world, TABLE_PLAYER_BULLET, 0)->y -= 10 * tick->dt;
+    }
+
+    size_t first = state->events.count;
+    GameEvent event;
+    if (detect_player_bullet(state, &tick->targets, &event))
+    {
+        push_event(&state->events, event);
+    }
+    resolve_events(state, &tick->targets, first);
+}
+
+// A playing tick in declared order, which is also the order they run in on one thread.
+static const FrameJob tick_jobs[] = {
+    {"animate", animate, 0, PART_ANIMATION | PART_PARTICLES | PART_ENTITIES},
+    {"steer player", steer_player, 0, PART_PLAYER | PART_STATUS | PART_TICK_PLAYING},
+    {"prepare targets", prepare_targets, PART_DESTROYABLES | PART_ENTITIES, PART_TARGETS},
+    {"shoot", shoot, PART_TICK_PLAYING | PART_PLAYER, PART_PLAYER_BULLET | PART_ENTITIES},
+    {"move formation", move_formation, PART_TICK_PLAYING, PART_FORMATION | PART_ENEMY_SLOTS | PART_STATUS},
+    {"fire enemies", fire_enemies,
+     PART_TICK_PLAYING | PART_ANIMATION | PART_FORMATION | PART_ENEMY_SLOTS | PART_ENTITIES,
+     PART_ENEMY_FIRE | PART_ENEMY_BULLETS | PART_ENTITIES},
+    {"move enemy bullets", move_enemy_bullets, PART_TICK_PLAYING | PART_ENTITIES,
+     PART_ENEMY_BULLETS | PART_TARGETS | PART_DESTROYABLES | PART_PLAYER | PART_STATUS | PART_EVENTS | PART_ENTITIES},
+    {"fly player bullet", fly_player_bullet, PART_TICK_PLAYING | PART_ANIMATION | PART_FORMATION | PART_ENTITIES,
+     PART_PLAYER_BULLET | PART_ENEMY_SLOTS | PART_ENEMY_FIRE | PART_PARTICLES | PART_TARGETS | PART_DESTROYABLES |
+         PART_SCORE | PART_STATUS | PART_EVENTS | PART_ENTITIES},
+};
+
+void game_tick_graph(FrameGraph *graph)
+{
+    frame_graph_init(graph, tick_jobs, NOB_ARRAY_LEN(tick_jobs));
+}
+
+// Running in declared order needs no waves, so the serial graph is a constant every game can share.
+static const FrameGraph tick_graph_in_order = {
+    .jobs = tick_jobs,
+    .count = NOB_ARRAY_LEN(tick_jobs),
+};
+
+static void update_playing(State *state, uint8_t input, float dt, const FrameGraph *graph, ThreadPool *pool)
+{
+    Tick tick = {
+        .state = state,
+        .input = input,
+        .dt = dt,
+        .dt_ns = accumulator_ns(dt),
+        .was_playing = state->status == PLAYING,
+    };
+
+    if (pool != NULL)
+    {
+        frame_graph_run_parallel(graph, &tick, pool);
+    }
+    else
+    {
+        frame_graph_run(graph, &tick);
+    }
+}
+
+// Keeps where everything was at the start of the tick so rendering can blend towards the new positions, a column at a
+// time for every table of moving entities.
+static void remember_positions(State *state)
+{
+    state->formation.previous_origin = state->formation.origin;
+
+    WorldQuery query = world_query(HAS(POSITION) | HAS(PREVIOUS_POSITION), 0);
+    for (EntityChunk chunk; entities_next(&state->world, &query, &chunk);)
+    {
+        memcpy(chunk.previous_position, chunk.position, chunk.count * sizeof(*chunk.position));
+    }
+}
+
+Vector2 interpolate_position(Vector2 previous_position, Vector2 position, float alpha)
+{
+    return Vector2Lerp(previous_position, position, alpha);
+}
+
+static void update(State *state, uint8_t input, float dt, const FrameGraph *graph, ThreadPool *pool)
+{
+    uint64_t dt_ns = accumulator_ns(dt);
+    remember_positions(state);
+    state->events.count = 0;
+
+    switch (state->status)
+    {
+    case WAITING:
+    case PLAYING:
+        update_playing(state, input, dt, graph, pool);
+        break;
+
+    case WON:
+    case LOST:
+        if (accumulator_tick(&state->time_to_accept_input, dt_ns, When_Tick_Ends_Keep) &&
+            (input & (INPUT_LEFT | INPUT_RIGHT)))
+        {
+            setup(state);
+            state->status = PLAYING;
+        }
+        break;
+
+    default:
+        NOB_UNREACHABLE("Status was bad?\n");
+        break;
+    }
+}
+
+void game_update(State *state, uint8_t input, float dt)
+{
+    update(state, input, dt, &tick_graph_in_order, NULL);
+}
+
+void game_update_parallel(State *state, uint8_t input, float dt, const FrameGraph *graph, ThreadPool *pool)
+{
+    update(state, input, dt, graph, pool);
+}
@@ -0,0 +1,364 @@
+#pragma once
+
+#include "accumulator.h"
+#include "archetype.h"
+#include "frame_graph.h"
+#include "raylib.h"
+#include "rng.h"
+#include "slot_map.h"
+#include "stddef.h"
+#include "timer_wheel.h"
+
+typedef struct
+{
+    uint8_t x;
+    uint8_t y;
+} AtlasPiece;
+
+typedef struct
+{
+    uint8_t offset_width;
+    uint8_t offset_height;
+    uint8_t width;
+    uint8_t height;
+    uint8_t pieces_count;
+    AtlasPiece pieces[];
+} AtlasDefinition;
+
+// Stable names for the atlases in the sprite sheet, used wherever a pointer can not be stored (files, snapshots).
+typedef enum
+{
+    ATLAS_SQUID,
+    ATLAS_SQUID_BULLET,
+    ATLAS_SKULL,
+    ATLAS_SKULL_BULLET,
+    ATLAS_REGULAR,
+    ATLAS_REGULAR_BULLET,
+    ATLAS_PLAYER,
+    ATLAS_PLAYER_BULLET,
+    ATLAS_DESTROYABLE,
+    ATLAS_DESTROY_EXPLOSION,
+    ATLAS_COUNT,
+    ATLAS_NONE = 0xFF,
+} AtlasId;
+
+// Every animation steps through its atlas once per ANIMATION_FRAME_NS, so its frame follows from State.animation_ns and
+// the time it started at, and nothing is ticked per sprite.
+#define ANIMATION_FRAME_NS (200 * ACCUMULATOR_NS_PER_MS)
+
+typedef struct
+{
+    uint8_t atlas; // AtlasId
+    // State.animation_ns when the animation started.
+    uint64_t phase_ns;
+} Animator;
+
+typedef struct
+{
+    AtlasId atlas;
+    AtlasId bullet_atlas;
+} EnemyTypeInfo;
+
+typedef struct
+{
+    EnemyTypeInfo enemy_regular, enemy_squid, enemy_skull, enemy_head, enemy_horns;
+} EnemyTypes;
+
+#define ENEMY_ROWS 3
+#define COLUMNS 8
+
+#define EMPTY_ROWS 4
+#define ENEMIES_GAME_OVER_ROW 5
+#define GAME_ROWS (ENEMY_ROWS + EMPTY_ROWS + 1)
+
+// Collections live inside State with a fixed capacity, so State holds no pointers and a snapshot is a plain copy.
+#define MAX_ENEMIES (COLUMNS * ENEMY_ROWS)
+_Static_assert(COLUMNS <= 64, "a formation row is a 64 bit mask");
+#define MAX_ENEMY_BULLETS 1024
+#define MAX_DESTROYABLES 3
+#define MAX_PARTICLES 64
+
+// Every component an entity can have, with its type and the name of its column in an EntityChunk.
+#define GAME_COMPONENTS(X)                                                                                             \
+    X(POSITION, Vector2, position)                                                                                     \
+    X(PREVIOUS_POSITION, Vector2, previous_position)                                                                   \
+    X(ANIMATOR, Animator, animator)                                                                                    \
+    /* Bullets fall a step each time theirs triggers, the player can shoot again once theirs does. */                  \
+    X(TIMING, Accumulator, timing)                                                                                     \
+    X(HEALTH, uint8_t, health)                                                                                         \
+    /* The formation slot an enemy fills. */                                                                           \
+    X(SLOT, uint8_t, slot)                                                                                             \
+    /* An enemy fires every fire_interval_ms through the timer of its slot in State.timers, which is only scheduled */ \
+    /* on the first playing tick after setup(), once the tick length is known. */                                      \
+    X(FIRE_INTERVAL, uint16_t, fire_interval_ms)                                                                       \
+    /* Playing time an enemy's next shot is due at, on the clock of State.timers. */                                   \
+    X(FIRE_NEXT, uint64_t, fire_next_ns)                                                                               \
+    X(BULLET_ATLAS, uint8_t, bullet_atlas) /* AtlasId */
+
+typedef enum
+{
+#define X(id, type, name) COMPONENT_##id,
+    GAME_COMPONENTS(X)
+#undef X
+        COMPONENT_COUNT,
+} ComponentId;
+_Static_assert(COMPONENT_COUNT <= ARCHETYPE_MAX_COMPONENTS, "too many components for a ComponentMask");
+
+#define HAS(id) ((ComponentMask)(1u << COMPONENT_##id))
+
+// The tables of State.world, one per kind of entity, in the order they are drawn.
+typedef enum
+{
+    // Static scenery, drawn by health.
+    TABLE_SHIELDS,
+    // Enemies have no position of their own, the formation places each by its slot, see Formation.
+    TABLE_ENEMIES,
+    TABLE_ENEMY_BULLETS,
+    // They all play the same explosion once and are despawned when it ends. When all MAX_PARTICLES are live, a new one
+    // replaces the oldest. See State.oldest_particle for their order.
+    TABLE_PARTICLES,
+    // Always exactly one row.
+    TABLE_PLAYER,
+    // One row while the player's bullet is in flight.
+    TABLE_PLAYER_BULLET,
+    TABLE_COUNT,
+} TableId;
+
+// Rows [first, first + count) of a table with its columns typed, NULL for the components it does not have.
+typedef struct
+{
+    size_t table;
+    size_t first;
+    size_t count;
+#define X(id, type, name) type *name;
+    GAME_COMPONENTS(X)
+#undef X
+} EntityChunk;
+
+static inline EntityChunk entity_chunk(const ArchetypeChunk *chunk)
+{
+    return (EntityChunk){
+        .table = chunk->table,
+        .first = chunk->first,
+        .count = chunk->count,
+#define X(id, type, name) .name = chunk->columns[COMPONENT_##id],
+        GAME_COMPONENTS(X)
+#undef X
+    };
+}
+
+// Typed world_query_next(). Loop with
+//     WorldQuery query = world_query(HAS(POSITION) | HAS(ANIMATOR), 0);
+//     for (EntityChunk chunk; entities_next(world, &query, &chunk);)
+static inline bool entities_next(const World *world, WorldQuery *query, EntityChunk *chunk)
+{
+    ArchetypeChunk columns;
+    if (!world_query_next(world, query, &columns))
+    {
+        return false;
+    }
+    *chunk = entity_chunk(&columns);
+    return true;
+}
+
+// Chunk `chunk` of one table, typed.
+static inline EntityChunk entity_table_chunk(const World *world, size_t table, size_t chunk)
+{
+    ArchetypeChunk columns = world_chunk(world, table, chunk);
+    return entity_chunk(&columns);
+}
+
+// entity_position(world, table, row) and so on for every component: the typed world_get().
+#define X(id, type, name)                                                                                              \
+    static inline type *entity_##name(const World *world, size_t table, size_t row)                                    \
+    {                                                                                                                  \
+        return world_get(world, table, COMPONENT_##id, row);                                                           \
+    }
+GAME_COMPONENTS(X)
+#undef X
+
+// The invaders move as one rigid block, so moving the formation only moves the origin. Slots are row major: slot
+// row * COLUMNS + column is at origin + (column, row), which is where placing the formation puts the enemy filling it.
+// Each row also has a mask of its live columns. Whether anyone is alive, the live columns at either edge and the
+// lowest live row are a handful of bit operations on those masks, and loops over live enemies walk the set bits.
+typedef struct
+{
+    Vector2 origin;
+    Vector2 previous_origin;
+    bool going_right;
+
+    uint64_t alive[ENEMY_ROWS];
+    // The enemy filling each live slot. Its row in TABLE_ENEMIES moves whenever another enemy dies.
+    Handle members[MAX_ENEMIES];
+    bool fire_scheduled;
+} Formation;
+
+// Timers of the whole game on one wheel. The fire timer of enemy slot i is timer i.
+#define MAX_TIMERS MAX_ENEMIES
+_Static_assert(MAX_TIMERS < TIMER_NONE, "timer ids are 16 bit");
+
+typedef enum
+{
+    TIMER_ENEMY_FIRE,
+} TimerTag;
+
+typedef struct
+{
+    TimerWheel wheel;
+    // Playing time at the wheel's current tick.
+    uint64_t now_ns;
+    TimerNode nodes[MAX_TIMERS];
+} Timers;
+
+// What bullets did during the last tick, in the order it was applied. Collision detection only appends events and
+// leaves the state alone, then resolving applies them, so anything else (sound, stats) can follow the game by reading
+// them after a tick.
+typedef enum
+{
+    // `target` is an entity of TABLE_ENEMIES.
+    EVENT_ENEMY_HIT,
+    // `target` is an entity of TABLE_SHIELDS.
+    EVENT_SHIELD_HIT,
+    // `target` is the entity of TABLE_PLAYER.
+    EVENT_PLAYER_HIT,
+    // The bullet left the world without hitting anything.
+    EVENT_BULLET_GONE,
+    EVENT_KIND_COUNT,
+} GameEventKind;
+
+#define MAX_EVENTS (MAX_ENEMY_BULLETS + 1)
+
+typedef struct
+{
+    uint8_t kind; // GameEventKind
+    // What the bullet hit, HANDLE_NONE for nothing.
+    Handle target;
+    // The enemy's or the player's bullet.
+    Handle bullet;
+} GameEvent;
+
+typedef struct
+{
+    GameEvent items[MAX_EVENTS];
+    size_t count;
+} GameEvents;
+
+typedef enum
+{
+    LOST,
+    WAITING,
+    PLAYING,
+    WON,
+} Status;
+
+// The values setup() and the update used to hardcode, so batch runs can sweep over them.
+typedef struct
+{
+    uint16_t fire_timer_min_ms;
+    uint16_t fire_timer_max_ms;
+    float enemy_speed;
+    uint8_t bullet_damage;
+} GameConfig;
+
+typedef struct
+{
+    GameConfig config;
+    // Every entity, in the tables of TableId.
+    World world;
+    // Particles are oldest first from this row of TABLE_PARTICLES on, wrapping around to row 0. A new one replaces the
+    // oldest in place when the table is full, which moves this on, and goes behind the others otherwise, where this
+    // is 0. So the finished ones are always the first few from here, and neither spawning nor despawning scans.
+    uint16_t oldest_particle;
+    Formation formation;
+    Timers timers;
+    GameEvents events;
+    Accumulator time_to_accept_input;
+    // Playing time since setup(), the clock every Animator runs on. It stands still outside of PLAYING.
+    uint64_t animation_ns;
+    Rng rng;
+    uint16_t score;
+    Status status;
+} State;
+
+// One bit per key the simulation reads, so a frame of input fits in a byte.
+typedef enum
+{
+    INPUT_LEFT = 1 << 0,
+    INPUT_RIGHT = 1 << 1,
+    INPUT_SHOOT = 1 << 2,
+} InputFlags;
+
+// The simulation always advances in steps of SIMULATION_DT, independently of the rendering frame rate.
+#define SIMULATION_TICK_RATE 60
+#define SIMULATION_DT (1.0f / SIMULATION_TICK_RATE)
+
+static const Vector2 BULLET_SIZE = {
+    .x = .3,
+    .y = .3,
+};
+
+static const Vector2 DESTROYABLE_SIZE = {
+    .x = 1.5,
+    .y = .5,
+};
+
+static const Vector2 PLAYER_SIZE = {
+    .x = 1,
+    .y = 1,
+};
+
+static const Vector2 ENEMY_SIZE = {
+    .x = 1,
+    .y = 1,
+};
+
+#define BULLET_DAMAGE 5
+#define ENEMY_FULL_HEALTH BULLET_DAMAGE
+#define PLAYER_FULL_HEALTH BULLET_DAMAGE
+
+#define DESTROYABLE_FULL_HEALTH (4 * BULLET_DAMAGE)
+#define DESTROYABLE_SECOND_HEALTH (3 * BULLET_DAMAGE)
+#define DESTROYABLE_THIRD_HEALTH (2 * BULLET_DAMAGE)
+#define DESTROYABLE_FOURTH_HEALTH (1 * BULLET_DAMAGE)
+
+const AtlasDefinition *atlas_definition(AtlasId id);
+
+GameConfig game_default_config(void);
+void game_init(State *state, const GameConfig *config, uint64_t seed);
+void setup(State *state);
+void game_update(State *state, uint8_t input, float dt);
+// The jobs of a playing tick with the parts of the state each one touches. game_update() runs them in order on the
+// calling thread, game_update_parallel() runs the independent ones of a wave at once on `pool`, with the same result.
+// A tick is a few hundred nanoseconds, an order of magnitude less than handing its jobs to other threads costs, so the
+// parallel path is only run by `--bench frame` to show the graph holds. Games tick inline.
+void game_tick_graph(FrameGraph *graph);
+void game_update_parallel(State *state, uint8_t input, float dt, const FrameGraph *graph, ThreadPool *pool);
+Vector2 interpolate_position(Vector2 previous_position, Vector2 position, float alpha);
+size_t enemies_alive(const State *state);
+Vector2 enemy_position(const Formation *formation, size_t slot);
+Vector2 enemy_previous_position(const Formation *formation, size_t slot);
+size_t destroyable_frame(uint8_t health);
+size_t animator_frame(const Animator *animator, uint64_t animation_ns);
+// Adds the tables of TableId to an empty world, as game_init() does. For filling a world some other way, like a replay.
+void game_world_init(World *world);
+// The size of every sprite of a table.
+Vector2 game_table_size(size_t table);
+
+// The first live slot at or after `from`, or MAX_ENEMIES. Loop with
+//     for (size_t i = enemies_next_alive(formation, 0); i < MAX_ENEMIES; i = enemies_next_alive(formation, i + 1))
+static inline size_t enemies_next_alive(const Formation *formation, size_t from)
+{
+    for (size_t row = from / COLUMNS; row < ENEMY_ROWS; ++row)
+    {
+        uint64_t bits = formation->alive[row];
+        if (row == from / COLUMNS)
+        {
+            bits &= ~0ull << (from % COLUMNS);
+        }
+        if (bits != 0)
+        {
+            return row * COLUMNS + __builtin_ctzll(bits);
+        }
+    }
+    return MAX_ENEMIES;
+}
@@ -0,0 +1,194 @@
+#include "headless.h"
+#include "nob.h"
+#include "replay.h"
+#include "rewind.h"
+
+uint8_t headless_scripted_input(size_t frame, const State *state)
+{
+    uint8_t input = INPUT_SHOOT;
+    Vector2 player = *entity_position(&state->world, TABLE_PLAYER, 0);
+
+    if (player.x <= 0)
+    {
+        input |= INPUT_RIGHT;
+    }
+    else if (player.x >= COLUMNS)
+    {
+        input |= INPUT_LEFT;
+    }
+    else
+    {
+        input |= (frame / 240) % 2 == 0 ? INPUT_RIGHT : INPUT_LEFT;
+    }
+
+    return input;
+}
+
+static const char *status_name(Status status)
+{
+    switch (status)
+    {
+    case LOST:
+        return "lost";
+    case WAITING:
+        return "waiting";
+    case PLAYING:
+        return "playing";
+    case WON:
+        return "won";
+    default:
+        NOB_UNREACHABLE("Status was bad?\n");
+    }
+}
+
+void headless_print_state(const State *state)
+{
+    printf("status:            %s\n", status_name(state->status));
+    printf("score:             %u\n", state->score);
+    const World *world = &state->world;
+    const Archetype *bullets = &world->tables[TABLE_ENEMY_BULLETS];
+    Vector2 player = *entity_position(world, TABLE_PLAYER, 0);
+    printf("enemies alive:     %zu/%d\n", enemies_alive(state), MAX_ENEMIES);
+    printf("enemy bullets:     %u (at most %u of %d)\n", bullets->count, bullets->high_water, MAX_ENEMY_BULLETS);
+    printf("particles:         %u\n", world->tables[TABLE_PARTICLES].count);
+    printf("player position:   %.3f %.3f\n", player.x, player.y);
+}
+
+// Rewinds as far as `checkpoint` was taken and compares, reporting what pushing and popping every tick costs.
+static bool finish_rewind_check(Rewind *rewind, State *state, const State *checkpoint, size_t depth,
+                                uint64_t push_ns, size_t pushes)
+{
+    size_t bytes = rewind_bytes_used(rewind);
+    size_t kept = rewind->count;
+
+    uint64_t start = nob_nanos_since_unspecified_epoch();
+    size_t pops = 0;
+    while (pops < depth && rewind_pop(rewind, state))
+    {
+        pops += 1;
+    }
+    uint64_t pop_ns = nob_nanos_since_unspecified_epoch() - start;
+
+    printf("rewind kept:       %zu ticks in %zu bytes (%.1f bytes per tick, State is %zu bytes)\n", kept, bytes,
+           kept > 0 ? (double)bytes / kept : 0.0, sizeof(State));
+    printf("rewind push:       %.1f ns\n", pushes > 0 ? (double)push_ns / pushes : 0.0);
+    printf("rewind pop:        %.1f ns\n", pops > 0 ? (double)pop_ns / pops : 0.0);
+
+    if (pops != depth || memcmp(state, checkpoint, sizeof(State)) != 0)
+    {
+        nob_log(NOB_ERROR, "rewinding %zu ticks did not restore the state from %zu ticks ago", pops, depth);
+        return false;
+    }
+    printf("rewound:           %zu ticks, state matches\n", pops);
+    return true;
+}
+
+int run_headless(const HeadlessOptions *options)
+{
+    State state;
+    GameConfig config = game_default_config();
+    game_init(&state, &config, options->seed);
+
+    size_t wins = 0;
+    size_t losses = 0;
+    size_t games = 1;
+    size_t events[EVENT_KIND_COUNT] = {0};
+
+    ReplayRecorder recorder = {0};
+    if (options->record_path != NULL)
+    {
+        replay_recorder_begin(&recorder, options->seed, options->dt, options->keyframe_interval);
+    }
+
+    Rewind rewind = {0};
+    State checkpoint = {0};
+    size_t rewind_depth = options->frames < REWIND_CAPACITY / 2 ? options->frames : REWIND_CAPACITY / 2;
+    uint64_t push_ns = 0;
+    if (options->rewind)
+    {
+        if (!rewind_init(&rewind, REWIND_DEFAULT_ARENA_SIZE))
+        {
+            nob_log(NOB_ERROR, "could not allocate the rewind buffer");
+            return 1;
+        }
+        rewind_push(&rewind, &state);
+        if (rewind_depth == options->frames)
+        {
+            memcpy(&checkpoint, &state, sizeof(State));
+        }
+    }
+
+    uint64_t start = nob_nanos_since_unspecified_epoch();
+
+    for (size_t frame = 0; frame < options->frames; ++frame)
+    {
+        Status before = state.status;
+        uint8_t input = headless_scripted_input(frame, &state);
+        if (options->record_path != NULL)
+        {
+            replay_recorder_tick(&recorder, &state, input);
+        }
+        game_update(&state, input, options->dt);
+        for (size_t i = 0; i < state.events.count; ++i)
+        {
+            events[state.events.items[i].kind] += 1;
+        }
+
+        if (options->rewind)
+        {
+            uint64_t push_start = nob_nanos_since_unspecified_epoch();
+            rewind_push(&rewind, &state);
+            push_ns += nob_nanos_since_unspecified_epoch() - push_start;
+
+            if (frame + 1 + rewind_depth == options->frames)
+            {
+                memcpy(&checkpoint, &state, sizeof(State));
+            }
+        }
+
+        if (before != state.status)
+        {
+            if (state.status == WON)
+            {
+                wins += 1;
+            }
+            else if (state.status == LOST)
+            {
+                losses += 1;
+            }
+            else if (before == WON || before == LOST)
+            {
+                games += 1;
+            }
+        }
+    }
+
+    uint64_t elapsed = nob_nanos_since_unspecified_epoch() - start;
+    double seconds = (double)elapsed / NOB_NANOS_PER_SEC;
+
+    printf("frames:            %zu\n", options->frames);
+    printf("elapsed:           %.3f s\n", seconds);
+    printf("frames per second: %.0f\n", seconds > 0 ? options->frames / seconds : 0.0);
+    printf("ns per frame:      %.1f\n", options->frames > 0 ? (double)elapsed / options->frames : 0.0);
+    printf("games:             %zu (%zu won, %zu lost)\n", games, wins, losses);
+    printf("hits:              %zu enemies, %zu shields, %zu player, %zu misses\n", events[EVENT_ENEMY_HIT],
+           events[EVENT_SHIELD_HIT], events[EVENT_PLAYER_HIT], events[EVENT_BULLET_GONE]);
+    headless_print_state(&state);
+
+    int result = 0;
+    if (options->rewind)
+    {
+        if (!finish_rewind_check(&rewind, &state, &checkpoint, rewind_depth, push_ns, options->frames))
+        {
+            result = 1;
+        }
+        rewind_free(&rewind);
+    }
+
+    if (options->record_path != NULL && !replay_recorder_finish(&recorder, options->record_path))
+    {
+        return 1;
+    }
+
+    return result;
+}
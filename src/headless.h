@@ -0,0 +1,24 @@
+#pragma once
+
+#include "game.h"
+
+typedef struct
+{
+    size_t frames;
+    uint64_t seed;
+    float dt;
+    // Optional replay to record the run to.
+    const char *record_path;
+    uint32_t keyframe_interval;
+    // Push every tick into a rewind buffer, then rewind and check the result against a copy.
+    bool rewind;
+} HeadlessOptions;
+
+// A player that sweeps the screen while holding fire. It is a pure function of the frame number and the state so
+// that a run only depends on its options.
+uint8_t headless_scripted_input(size_t frame, const State *state);
+
+void headless_print_state(const State *state);
+
+// Runs the simulation without a window as fast as possible and prints throughput and final stats.
+int run_headless(const HeadlessOptions *options);
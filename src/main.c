@@ -1,783 +1,404 @@
-#include "accumulator.h"
+#include "batch.h"
+#include "bench.h"
+#include "game.h"
+#include "headless.h"
+#include "replay.h"
+#include "render_list.h"
+#include "rewind.h"
+#include "sprite_batch.h"
+#include "triple_buffer.h"
 #define NOB_IMPLEMENTATION
 #include "nob.h"
 #include "raylib.h"
 #include "raymath.h"
 
-#define min(a, b) (a) < (b) ? (a) : (b)
-
-typedef struct
-{
-    uint8_t x;
-    uint8_t y;
-} AtlasPiece;
-
-typedef struct
-{
-    uint8_t offset_width;
-    uint8_t offset_height;
-    uint8_t width;
-    uint8_t height;
-    uint8_t pieces_count;
-    AtlasPiece pieces[];
-} AtlasDefinition;
-
-typedef struct
-{
-    Texture2D *texture;
-    AtlasDefinition *atlas_definition;
-    Accumulator accumulator;
-    size_t current_frame;
-} Animator;
-
-typedef struct
-{
-    Accumulator accumulator;
-    Animator bullet_animator;
-} EnemyShooting;
-
-typedef struct
-{
-    AtlasDefinition *atlas;
-    AtlasDefinition *bullet_atlas;
-} EnemyTypeInfo;
+#include "float.h"
+#include "pthread.h"
+#include "stdatomic.h"
+#include "time.h"
 
-typedef struct
-{
-    EnemyTypeInfo enemy_regular, enemy_squid, enemy_skull, enemy_head, enemy_horns;
-} EnemyTypes;
-
-typedef struct
-{
-    Vector2 position;
-    EnemyShooting shooting;
-    Animator animator;
-    uint8_t health;
-} Enemy;
-
-typedef struct
-{
-    Enemy *items;
-    size_t count;
-    size_t capacity;
-} Enemies;
-
-typedef struct
-{
-    Animator animator;
-    Accumulator timing;
-    Vector2 position;
-    bool destroyed;
-} Bullet;
-
-typedef struct
-{
-    Bullet *items;
-    size_t count;
-    size_t capacity;
-} Bullets;
-
-typedef struct
-{
-    Animator animator;
-    Vector2 position;
-    uint8_t health;
-} Destroyable;
-
-typedef struct
-{
-    Destroyable *items;
-    size_t count;
-    size_t capacity;
-} Destroyables;
-
-typedef struct
-{
-    Vector2 position;
-    Accumulator shooting;
-    Animator animator;
-    Bullet bullet;
-    uint8_t health;
-} Player;
+#define min(a, b) (a) < (b) ? (a) : (b)
 
-typedef struct
-{
-    Animator animator;
-    Vector2 position;
-    bool finished;
-} Particle;
+#define MAX_FRAME_TIME_NS 250000000ull
+#define SIMULATION_DT_NS (1000000000ull / SIMULATION_TICK_RATE)
 
+// A published simulation tick, which the window draws from.
 typedef struct
 {
-    Particle *items;
-    size_t count;
-    size_t capacity;
-} Particles;
-
-typedef enum
-{
-    LOST,
-    WAITING,
-    PLAYING,
-    WON,
-} Status;
-
+    State state;
+    // Clock time at which the simulation reached this tick, so drawing can blend towards it by how long ago that was.
+    uint64_t tick_ns;
+} Snapshot;
+
+// Gameplay runs on its own thread at a fixed rate and publishes every tick it reaches, while the window thread, which
+// owns raylib, draws the newest one. Neither waits for the other: a slow frame or vsync wait does not hold up a tick,
+// and a slow tick leaves the window drawing the last one. This is all they share.
 typedef struct
 {
-    Bullets enemy_bullets;
-    Enemies enemies;
-    bool enemies_going_right;
-    Destroyables destroyables;
-    Particles particles;
-    Player player;
-    uint16_t score;
-    Status status;
-} State;
-
-#define ENEMY_ROWS 3
-#define COLUMNS 8
-
-#define EMPTY_ROWS 4
-#define ENEMIES_GAME_OVER_ROW 5
-#define GAME_ROWS (ENEMY_ROWS + EMPTY_ROWS + 1)
-
-static const Vector2 BULLET_SIZE = {
-    .x = .3,
-    .y = .3,
-};
-
-static const Vector2 DESTROYABLE_SIZE = {
-    .x = 1.5,
-    .y = .5,
-};
-
-static const Vector2 PLAYER_SIZE = {
-    .x = 1,
-    .y = 1,
-};
-
-static const Vector2 ENEMY_SIZE = {
-    .x = 1,
-    .y = 1,
-};
-
-static Vector2 world_to_screen(const Vector2 world_coordinates, float scale, const Vector2 offset)
+    // Keys held on the window's last frame, as InputFlags.
+    atomic_uint input;
+    atomic_bool rewinding;
+    // Set by the window on a key press, cleared by the simulation once it handled them.
+    atomic_bool save_requested;
+    atomic_bool load_requested;
+    atomic_bool quit;
+
+    TripleBuffer snapshots;
+    Snapshot slots[TRIPLE_BUFFER_SLOTS];
+
+    // Only the simulation thread touches these while it runs.
+    State state;
+    const char *record_path;
+    ReplayRecorder recorder;
+    bool can_travel;
+    Rewind rewind;
+} Simulation;
+
+static void publish_snapshot(Simulation *simulation, uint64_t tick_ns)
 {
-    Vector2 position = Vector2Scale(world_coordinates, scale);
-    position = Vector2Add(position, offset);
-    return position;
+    Snapshot *snapshot = &simulation->slots[triple_buffer_back(&simulation->snapshots)];
+    snapshot->state = simulation->state;
+    snapshot->tick_ns = tick_ns;
+    triple_buffer_publish(&simulation->snapshots);
 }
 
-typedef enum
+static void *run_simulation(void *data)
 {
-    NONE,
-    BULLET,
-    DESTROYABLE,
-    PLAYER = 3,
-    ENEMY = 3,
-} EntityType;
-
-typedef struct
-{
-    EntityType entity_type;
-    const void *entity;
-} HitResult;
-
-#define BULLET_DAMAGE 5
-
-#define DESTROYABLE_FULL_HEALTH (4 * BULLET_DAMAGE)
-#define DESTROYABLE_SECOND_HEALTH (3 * BULLET_DAMAGE)
-#define DESTROYABLE_THIRD_HEALTH (2 * BULLET_DAMAGE)
-#define DESTROYABLE_FOURTH_HEALTH (1 * BULLET_DAMAGE)
-
-#define check_collisions(Type, it, da, Size, Checking, label)                                                          \
-    nob_da_foreach(Type, it, da)                                                                                       \
-    {                                                                                                                  \
-        Rectangle __bullet_collision_box = {                                                                           \
-            .width = BULLET_SIZE.x,                                                                                    \
-            .height = BULLET_SIZE.y,                                                                                   \
-            .x = bullet->position.x,                                                                                   \
-            .y = bullet->position.y,                                                                                   \
-        };                                                                                                             \
-                                                                                                                       \
-        if (it->health <= 0)                                                                                           \
-        {                                                                                                              \
-            continue;                                                                                                  \
-        }                                                                                                              \
-                                                                                                                       \
-        Rectangle __collision_box = {                                                                                  \
-            .width = Size.x,                                                                                           \
-            .height = Size.y,                                                                                          \
-            .x = it->position.x,                                                                                       \
-            .y = it->position.y,                                                                                       \
-        };                                                                                                             \
-                                                                                                                       \
-        if (CheckCollisionRecs(__collision_box, __bullet_collision_box))                                               \
-        {                                                                                                              \
-            it->health -= BULLET_DAMAGE;                                                                               \
-            bullet->destroyed = true;                                                                                  \
-            result = (HitResult){                                                                                      \
-                .entity = it,                                                                                          \
-                .entity_type = Checking,                                                                               \
-            };                                                                                                         \
-            goto label;                                                                                                \
-        }                                                                                                              \
-    }
-
-#define nob_da_pool(Type, var, da)                                                                                     \
-    do                                                                                                                 \
-    {                                                                                                                  \
-        bool __found = false;                                                                                          \
-        nob_da_foreach(Type, _it, (da))                                                                                \
-        {                                                                                                              \
-            if (_it->finished)                                                                                         \
-            {                                                                                                          \
-                var = _it;                                                                                             \
-                __found = true;                                                                                        \
-                break;                                                                                                 \
-            }                                                                                                          \
-        }                                                                                                              \
-        if (!__found)                                                                                                  \
-        {                                                                                                              \
-            nob_da_append((da), (Type){0});                                                                            \
-            var = &nob_da_last((da));                                                                                  \
-        }                                                                                                              \
-    } while (0)
-
-static bool all_enemies_defeated(const State *state)
-{
-    nob_da_foreach(Enemy, enemy, &state->enemies)
+    Simulation *simulation = data;
+    State *state = &simulation->state;
+    State saved = *state;
+
+    // Real time not yet consumed by simulation ticks.
+    uint64_t lag_ns = 0;
+    uint64_t last_ns = nob_nanos_since_unspecified_epoch();
+    while (!atomic_load(&simulation->quit))
     {
-        if (enemy->health > 0)
+        uint64_t now_ns = nob_nanos_since_unspecified_epoch();
+        // Cap how much time a single stall can ask the simulation to catch up on.
+        lag_ns += now_ns - last_ns < MAX_FRAME_TIME_NS ? now_ns - last_ns : MAX_FRAME_TIME_NS;
+        last_ns = now_ns;
+
+        bool changed = false;
+        if (atomic_exchange(&simulation->save_requested, false))
         {
-            return false;
+            saved = *state;
         }
-    }
-
-    return true;
-}
-
-static void move_player_bullet(State *state, AtlasDefinition *enemy_destroyed_atlas, Texture *enemy_destroyed_texture)
-{
-    Bullet *bullet = &state->player.bullet;
-
-    if (bullet->position.y <= 0)
-    {
-        bullet->destroyed = true;
-    }
-
-    if (bullet->destroyed)
-    {
-        return;
-    }
-
-    HitResult result = {0};
-
-    check_collisions(Enemy, enemy, &state->enemies, ENEMY_SIZE, ENEMY, move_player_bullet_after_collision);
-    check_collisions(Destroyable, destroyable, &state->destroyables, DESTROYABLE_SIZE, DESTROYABLE,
-                     move_player_bullet_after_collision);
-    goto no_hit;
-
-move_player_bullet_after_collision:
-    if (result.entity_type == ENEMY)
-    {
-        state->score += 10;
-        Particle *particle = NULL;
-        nob_da_pool(Particle, particle, &state->particles);
-        assert(particle);
-
-        particle->finished = false;
-        particle->animator = (Animator){
-            .accumulator =
-                (Accumulator){
-                    .ms_accumulated = 0,
-                    .ms_to_trigger = 200,
-                },
-            .atlas_definition = enemy_destroyed_atlas,
-            .current_frame = 0,
-            .texture = enemy_destroyed_texture,
-        };
-        particle->position = ((Enemy *)result.entity)->position;
-
-        if (all_enemies_defeated(state))
+        if (atomic_exchange(&simulation->load_requested, false) && simulation->can_travel)
         {
-            state->status = WON;
+            *state = saved;
+            rewind_clear(&simulation->rewind);
+            rewind_push(&simulation->rewind, state);
+            changed = true;
         }
-    }
-no_hit:
-}
+        bool rewinding = simulation->can_travel && atomic_load(&simulation->rewinding);
 
-static void setup(State *state, const EnemyTypes *enemy_types, AtlasDefinition *player_atlas,
-                  AtlasDefinition *destroyable_atlas, Texture2D *sprite_sheet_texture)
-{
-    state->enemy_bullets.count = 0;
-    state->enemies.count = 0;
-    state->enemies_going_right = true;
-    state->destroyables.count = 0;
-    state->particles.count = 0;
-
-    state->player = (Player){
-        .position =
-            {
-                .x = COLUMNS / 2,
-                .y = GAME_ROWS - 1,
-            },
-        .shooting =
-            {
-                .ms_accumulated = 0,
-                .ms_to_trigger = 200,
-            },
-        .animator =
+        uint8_t input = atomic_load(&simulation->input);
+        while (lag_ns >= SIMULATION_DT_NS)
+        {
+            if (rewinding)
             {
-                .atlas_definition = player_atlas,
-                .accumulator =
-                    {
-                        .ms_accumulated = 0,
-                        .ms_to_trigger = 200,
-                    },
-                .current_frame = 0,
-                .texture = sprite_sheet_texture,
-            },
-        .bullet =
+                rewind_pop(&simulation->rewind, state);
+            }
+            else
             {
-                .position = {0},
-                .timing = {0},
-                .destroyed = true,
-            },
-        .health = BULLET_DAMAGE,
-    };
-
-    state->score = 0;
+                if (simulation->record_path != NULL)
+                {
+                    replay_recorder_tick(&simulation->recorder, state, input);
+                }
+                game_update(state, input, SIMULATION_DT);
+                if (simulation->can_travel)
+                {
+                    rewind_push(&simulation->rewind, state);
+                }
+            }
+            lag_ns -= SIMULATION_DT_NS;
+            changed = true;
+        }
 
-    for (size_t i = 0; i < COLUMNS; ++i)
-    {
-        for (size_t j = 0; j < ENEMY_ROWS; ++j)
+        if (changed)
         {
-            EnemyTypeInfo info = (j == 0 || j == 1) ? enemy_types->enemy_squid : enemy_types->enemy_regular;
-
-            AtlasDefinition *atlas = info.atlas;
-            AtlasDefinition *bullet_atlas = info.bullet_atlas;
-
-            Enemy enemy = {
-                .position = {.x = i, .y = j},
-                .shooting =
-                    (EnemyShooting){
-                        .accumulator =
-                            {
-                                .ms_accumulated = 0,
-                                .ms_to_trigger = GetRandomValue(5000, 30000),
-                            },
-                        .bullet_animator =
-                            {
-                                .texture = sprite_sheet_texture,
-                                .atlas_definition = bullet_atlas,
-                                .current_frame = 0,
-                                .accumulator =
-                                    {
-                                        .ms_accumulated = 0,
-                                        .ms_to_trigger = 200,
-                                    },
-                            },
-                    },
-                .animator =
-                    {
-                        .texture = sprite_sheet_texture,
-                        .atlas_definition = atlas,
-                        .current_frame = 0,
-                        .accumulator =
-                            {
-                                .ms_accumulated = 0,
-                                .ms_to_trigger = 200,
-                            },
-                    },
-                .health = BULLET_DAMAGE,
-            };
-            nob_da_append(&state->enemies, enemy);
+            publish_snapshot(simulation, now_ns - lag_ns);
         }
-    }
 
-    for (size_t i = 0; i < 3; ++i)
-    {
-        int y = ENEMY_ROWS + 2;
-        int x = (i + 1) * 2;
-        nob_da_append(&state->destroyables, ((Destroyable){
-                                                .health = DESTROYABLE_FULL_HEALTH,
-                                                .animator =
-                                                    {
-                                                        .accumulator = {.ms_accumulated = 0, .ms_to_trigger = 0},
-                                                        .atlas_definition = destroyable_atlas,
-                                                        .texture = sprite_sheet_texture,
-                                                        .current_frame = 0,
-                                                    },
-                                                .position =
-                                                    {
-                                                        .x = x,
-                                                        .y = y,
-                                                    },
-                                            }));
+        uint64_t wait_ns = SIMULATION_DT_NS - lag_ns;
+        nanosleep(&(struct timespec){.tv_sec = wait_ns / 1000000000, .tv_nsec = wait_ns % 1000000000}, NULL);
     }
+
+    return NULL;
+}
+
+// Replays a recorded frame through raylib.
+static void draw_render_list(SpriteBatch *batch, const SpriteUvs *uvs, const RenderList *list, Texture2D texture)
+{
+    sprite_batch_build(batch, uvs, list);
+    sprite_batch_flush(batch, texture);
 }
 
-static bool move_player(Vector2 *position)
+static uint8_t read_input(void)
 {
-    Vector2 next_direction = {0};
+    uint8_t input = 0;
 
     if (IsKeyDown(KEY_RIGHT) || IsKeyDown(KEY_D))
     {
-        next_direction.x += GetFrameTime();
+        input |= INPUT_RIGHT;
     }
-    else if (IsKeyDown(KEY_LEFT) || IsKeyDown(KEY_A))
+    if (IsKeyDown(KEY_LEFT) || IsKeyDown(KEY_A))
     {
-        next_direction.x -= GetFrameTime();
+        input |= INPUT_LEFT;
     }
-
-    Vector2 new_position = Vector2Add(next_direction, *position);
-
-    if (new_position.x <= 0)
-    {
-        new_position.x = 0;
-    }
-    else if (new_position.x >= COLUMNS)
+    if (IsKeyDown(KEY_SPACE))
     {
-        new_position.x = COLUMNS;
+        input |= INPUT_SHOOT;
     }
 
-    *position = new_position;
-    return next_direction.x != 0.0;
+    return input;
 }
 
-static void handle_player_shooting(Player *player, const Animator *bullet_animator)
+static void usage(const char *program)
 {
-    if (IsKeyDown(KEY_SPACE) && accumulator_tick(&player->shooting, GetFrameTime(), When_Tick_Ends_Keep) &&
-        player->bullet.destroyed)
-    {
-        player->shooting.ms_accumulated = 0;
-        player->bullet.position = (Vector2){
-            .x = player->position.x + PLAYER_SIZE.x / 2,
-            .y = player->position.y,
-        };
-        player->bullet.timing = (Accumulator){
-            .ms_accumulated = 0,
-            .ms_to_trigger = 200,
-        };
-        player->bullet.animator = *bullet_animator;
-        player->bullet.destroyed = false;
-    }
+    fprintf(stderr, "Usage: %s [MODE] [OPTIONS]\n", program);
+    fprintf(stderr, "Modes:\n");
+    fprintf(stderr, "    (none)                 play in a window\n");
+    fprintf(stderr, "    --headless             simulate without a window and print throughput\n");
+    fprintf(stderr, "    --batch                play many games on all cores and write a CSV\n");
+    fprintf(stderr, "    --replay PATH          play a recorded replay without a window, as fast as possible\n");
+    fprintf(stderr, "    --bench NAME           run a microbenchmark (aabb, grid, timers, accumulator, sprites,\n"
+            "                           frame)\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "    --frames N             frames to simulate (per game in batch mode)\n");
+    fprintf(stderr, "    --seed S               seed of the first game\n");
+    fprintf(stderr, "    --dt SECONDS           simulation step\n");
+    fprintf(stderr, "    --record PATH          record the window or headless session to a replay\n");
+    fprintf(stderr, "    --keyframe-interval N  ticks between full state keyframes in recorded replays\n");
+    fprintf(stderr, "    --rewind               headless: push every tick to a rewind buffer and check rewinding\n");
+    fprintf(stderr, "Replay options:\n");
+    fprintf(stderr, "    --seek TICK            jump to TICK instead of playing the whole replay\n");
+    fprintf(stderr, "    --verify               check that the simulation reproduces every keyframe\n");
+    fprintf(stderr, "Batch options:\n");
+    fprintf(stderr, "    --games N              games per configuration\n");
+    fprintf(stderr, "    --threads N            worker threads, 0 for one per CPU\n");
+    fprintf(stderr, "    --out PATH             CSV output path\n");
+    fprintf(stderr, "    --fire-min LIST        enemy fire timer minimums in ms, e.g. 3000,5000, up to 65535\n");
+    fprintf(stderr, "    --fire-max LIST        enemy fire timer maximums in ms, up to 65535\n");
+    fprintf(stderr, "    --enemy-speed LIST     formation speeds in columns per second\n");
+    fprintf(stderr, "    --bullet-damage LIST   damage dealt by every bullet, 1 to 255\n");
 }
 
-static void draw_sprite(const Animator *animator, float scale, const Vector2 offset, Vector2 world_position,
-                        const Vector2 world_size)
+typedef enum
+{
+    MODE_WINDOW,
+    MODE_HEADLESS,
+    MODE_BATCH,
+    MODE_REPLAY,
+    MODE_BENCH,
+} Mode;
+
+int main(int argc, char **argv)
 {
-    Vector2 position = world_to_screen(world_position, scale, offset);
-    Vector2 size = Vector2Scale(world_size, scale);
-
-    Rectangle destination_rec = {
-        .width = size.x,
-        .height = size.y,
-        .x = position.x,
-        .y = position.y,
+    const char *program = nob_shift(argv, argc);
+
+    Mode mode = MODE_WINDOW;
+    HeadlessOptions headless_options = {
+        .frames = 1000000,
+        .seed = 42,
+        .dt = SIMULATION_DT,
+        .record_path = NULL,
+        .keyframe_interval = REPLAY_DEFAULT_KEYFRAME_INTERVAL,
     };
 
-    AtlasPiece piece = animator->atlas_definition->pieces[animator->current_frame];
-    Rectangle source_rec = {.x = piece.x * animator->atlas_definition->width + animator->atlas_definition->offset_width,
-                            .y = piece.y * animator->atlas_definition->height +
-                                 animator->atlas_definition->offset_height,
-                            .height = animator->atlas_definition->height,
-                            .width = animator->atlas_definition->width};
-
-    DrawTexturePro(*animator->texture, source_rec, destination_rec, Vector2Zero(), 0.0f, WHITE);
-}
+    ReplayOptions replay_options = {0};
+    BenchOptions bench_options = {.seed = 42};
+
+    GameConfig default_config = game_default_config();
+    BatchOptions batch_options = {
+        .games_per_config = 100,
+        .max_frames = 60 * 60 * 10,
+        .threads = 0,
+        .seed = 42,
+        .dt = SIMULATION_DT,
+        .output_path = "batch.csv",
+        .fire_timer_min_ms = {.values = {default_config.fire_timer_min_ms}, .count = 1},
+        .fire_timer_max_ms = {.values = {default_config.fire_timer_max_ms}, .count = 1},
+        .enemy_speed = {.values = {default_config.enemy_speed}, .count = 1},
+        .bullet_damage = {.values = {default_config.bullet_damage}, .count = 1},
+    };
 
-static void draw_game(const State *state, float scale, const Vector2 offset)
-{
+    while (argc > 0)
     {
-        nob_da_foreach(Enemy, enemy, &state->enemies)
-        {
-            if (enemy->health <= 0)
-            {
-                continue;
-            }
+        const char *flag = nob_shift(argv, argc);
 
-            draw_sprite(&enemy->animator, scale, offset, enemy->position, ENEMY_SIZE);
+        if (strcmp(flag, "--headless") == 0)
+        {
+            mode = MODE_HEADLESS;
         }
-    }
-
-    {
-        nob_da_foreach(Bullet, bullet, &state->enemy_bullets)
+        else if (strcmp(flag, "--batch") == 0)
         {
-            draw_sprite(&bullet->animator, scale, offset, bullet->position, BULLET_SIZE);
+            mode = MODE_BATCH;
         }
-    }
-
-    {
-        nob_da_foreach(Particle, particle, &state->particles)
+        else if (strcmp(flag, "--replay") == 0 && argc > 0)
         {
-            if (particle->finished)
-            {
-                continue;
-            }
-
-            draw_sprite(&particle->animator, scale, offset, particle->position, ENEMY_SIZE);
+            mode = MODE_REPLAY;
+            replay_options.path = nob_shift(argv, argc);
         }
-    }
-
-    {
-        nob_da_foreach(Destroyable, destroyable, &state->destroyables)
+        else if (strcmp(flag, "--bench") == 0 && argc > 0)
         {
-            if (destroyable->health <= 0)
-            {
-                continue;
-            }
-
-            switch (destroyable->health)
-            {
-            case DESTROYABLE_FULL_HEALTH:
-                destroyable->animator.current_frame = 0;
-                break;
-            case DESTROYABLE_SECOND_HEALTH:
-                destroyable->animator.current_frame = 1;
-                break;
-            case DESTROYABLE_THIRD_HEALTH:
-                destroyable->animator.current_frame = 2;
-                break;
-            case DESTROYABLE_FOURTH_HEALTH:
-                destroyable->animator.current_frame = 3;
-                break;
-            default:
-                NOB_UNREACHABLE("Destroyable health was unexpected!\n");
-            }
-            draw_sprite(&destroyable->animator, scale, offset, destroyable->position, DESTROYABLE_SIZE);
+            mode = MODE_BENCH;
+            bench_options.name = nob_shift(argv, argc);
         }
-
+        else if (strcmp(flag, "--record") == 0 && argc > 0)
         {
-            draw_sprite(&state->player.animator, scale, offset, state->player.position, PLAYER_SIZE);
+            headless_options.record_path = nob_shift(argv, argc);
         }
-
-        if (!state->player.bullet.destroyed)
+        else if (strcmp(flag, "--rewind") == 0)
         {
-            draw_sprite(&state->player.bullet.animator, scale, offset, state->player.bullet.position, BULLET_SIZE);
+            headless_options.rewind = true;
         }
-    }
-}
-
-static AtlasDefinition squid_frames = {
-    .width = 16,
-    .height = 16,
-    .pieces_count = 2,
-    .offset_height = 0,
-    .offset_width = 0,
-    .pieces = {{
-                   .x = 0,
-                   .y = 1,
-               },
-               {
-                   .x = 1,
-                   .y = 1,
-               }},
-};
-
-static AtlasDefinition squid_bullet_frames = {
-    .width = 16,
-    .height = 16,
-    .offset_width = 0,
-    .offset_height = 0,
-    .pieces_count = 2,
-    .pieces =
+        else if (strcmp(flag, "--keyframe-interval") == 0 && argc > 0)
         {
+            headless_options.keyframe_interval = strtoul(nob_shift(argv, argc), NULL, 10);
+        }
+        else if (strcmp(flag, "--seek") == 0 && argc > 0)
+        {
+            replay_options.seek = true;
+            replay_options.seek_tick = strtoull(nob_shift(argv, argc), NULL, 10);
+        }
+        else if (strcmp(flag, "--verify") == 0)
+        {
+            replay_options.verify = true;
+        }
+        else if (strcmp(flag, "--frames") == 0 && argc > 0)
+        {
+            headless_options.frames = strtoull(nob_shift(argv, argc), NULL, 10);
+            batch_options.max_frames = headless_options.frames;
+        }
+        else if (strcmp(flag, "--seed") == 0 && argc > 0)
+        {
+            headless_options.seed = strtoull(nob_shift(argv, argc), NULL, 10);
+            batch_options.seed = headless_options.seed;
+            bench_options.seed = headless_options.seed;
+        }
+        else if (strcmp(flag, "--dt") == 0 && argc > 0)
+        {
+            headless_options.dt = strtof(nob_shift(argv, argc), NULL);
+            batch_options.dt = headless_options.dt;
+        }
+        else if (strcmp(flag, "--games") == 0 && argc > 0)
+        {
+            batch_options.games_per_config = strtoull(nob_shift(argv, argc), NULL, 10);
+        }
+        else if (strcmp(flag, "--threads") == 0 && argc > 0)
+        {
+            batch_options.threads = strtoull(nob_shift(argv, argc), NULL, 10);
+        }
+        else if (strcmp(flag, "--out") == 0 && argc > 0)
+        {
+            batch_options.output_path = nob_shift(argv, argc);
+        }
+        else if (strcmp(flag, "--fire-min") == 0 && argc > 0)
+        {
+            if (!batch_parse_sweep(&batch_options.fire_timer_min_ms, nob_shift(argv, argc), 0, UINT16_MAX, true))
             {
-                .x = 2,
-                .y = 1,
-            },
-            {
-                .x = 5,
-                .y = 1,
-            },
-        },
-};
-
-static AtlasDefinition skull_frames = {
-    .width = 16,
-    .height = 16,
-    .pieces_count = 2,
-    .offset_height = 0,
-    .offset_width = 0,
-    .pieces = {{
-                   .x = 0,
-                   .y = 2,
-               },
-               {
-                   .x = 1,
-                   .y = 2,
-               }},
-};
-
-static AtlasDefinition skull_bullet_frames = {
-    .width = 16,
-    .height = 16,
-    .pieces_count = 1,
-    .offset_width = 0,
-    .offset_height = 0,
-    .pieces =
+                usage(program);
+                return 1;
+            }
+        }
+        else if (strcmp(flag, "--fire-max") == 0 && argc > 0)
         {
+            if (!batch_parse_sweep(&batch_options.fire_timer_max_ms, nob_shift(argv, argc), 0, UINT16_MAX, true))
             {
-                .x = 2,
-                .y = 2,
-            },
-        },
-};
-
-static AtlasDefinition regular_frames = {
-    .width = 16,
-    .height = 16,
-    .pieces_count = 2,
-    .offset_height = 0,
-    .offset_width = 0,
-    .pieces = {{
-                   .x = 0,
-                   .y = 0,
-               },
-               {
-                   .x = 1,
-                   .y = 0,
-               }},
-};
-
-static AtlasDefinition regular_bullet_frames = {
-    .width = 16,
-    .height = 16,
-    .pieces_count = 1,
-    .offset_width = 0,
-    .offset_height = 0,
-    .pieces =
+                usage(program);
+                return 1;
+            }
+        }
+        else if (strcmp(flag, "--enemy-speed") == 0 && argc > 0)
         {
+            if (!batch_parse_sweep(&batch_options.enemy_speed, nob_shift(argv, argc), -FLT_MAX, FLT_MAX, false))
             {
-                .x = 2,
-                .y = 0,
-            },
-        },
-};
-
-static AtlasDefinition player_frames = {
-    .width = 16,
-    .height = 16,
-    .offset_height = 0,
-    .offset_width = 0,
-    .pieces_count = 1,
-    .pieces = {{
-        .x = 4,
-        .y = 0,
-    }},
-};
-
-static AtlasDefinition player_bullet_atlas = {
-    .width = 16,
-    .height = 16,
-    .offset_width = 0,
-    .offset_height = 0,
-    .pieces_count = 1,
-    .pieces =
+                usage(program);
+                return 1;
+            }
+        }
+        else if (strcmp(flag, "--bullet-damage") == 0 && argc > 0)
         {
+            if (!batch_parse_sweep(&batch_options.bullet_damage, nob_shift(argv, argc), 1, UINT8_MAX, true))
             {
-                .x = 2,
-                .y = 0,
-            },
-        },
-};
-
-static AtlasDefinition destroyable_frames = {
-    .width = 32,
-    .height = 16,
-    .offset_width = 16 * 3,
-    .offset_height = 16,
-    .pieces_count = 4,
-    .pieces = {{
-                   .x = 0,
-                   .y = 0,
-               },
-               {
-                   .x = 0,
-                   .y = 1,
-               },
-               {
-                   .x = 0,
-                   .y = 2,
-               },
-               {
-                   .x = 0,
-                   .y = 3,
-               }},
-};
-
-static AtlasDefinition destroy_explosion_frames = {
-    .width = 16,
-    .height = 16,
-    .offset_width = 0,
-    .offset_height = 0,
-    .pieces_count = 2,
-    .pieces = {{
-                   .x = 2,
-                   .y = 3,
-               },
-               {
-                   .x = 2,
-                   .y = 4,
-               }},
-};
-
-int main(void)
-{
-    InitWindow(800, 600, "Ray Invaders Game in Raylib");
+                usage(program);
+                return 1;
+            }
+        }
+        else
+        {
+            usage(program);
+            nob_log(NOB_ERROR, "unknown or incomplete flag `%s`", flag);
+            return 1;
+        }
+    }
+
+    switch (mode)
+    {
+    case MODE_HEADLESS:
+        return run_headless(&headless_options);
+    case MODE_BATCH:
+        return run_batch(&batch_options);
+    case MODE_REPLAY:
+        return run_replay(&replay_options);
+    case MODE_BENCH:
+        return run_bench(&bench_options);
+    case MODE_WINDOW:
+        break;
+    }
 
-    SetTargetFPS(60);
+    InitWindow(800, 600, "Ray Invaders Game in Raylib");
 
-    srand(time(NULL));
+    SetTargetFPS(GetMonitorRefreshRate(GetCurrentMonitor()));
 
     Texture2D sprite_sheet_texture = LoadTexture("resources/SpaceInvaders.png");
     Texture2D background_texture = LoadTexture("resources/background.jpg");
 
-    EnemyTypes enemy_types = {
-        .enemy_regular =
-            {
-                .atlas = &regular_frames,
-                .bullet_atlas = &regular_bullet_frames,
-            },
-        .enemy_squid =
-            {
-                .atlas = &squid_frames,
-                .bullet_atlas = &squid_bullet_frames,
-            },
-        .enemy_skull =
-            {
-                .atlas = &skull_frames,
-                .bullet_atlas = &skull_bullet_frames,
-            },
-        .enemy_head =
-            {
-                .atlas = &regular_frames,
-                .bullet_atlas = &regular_bullet_frames,
-            },
-        .enemy_horns =
-            {
-                .atlas = &squid_frames,
-                .bullet_atlas = &squid_bullet_frames,
-            },
-    };
+    SpriteUvs sprite_uvs;
+    sprite_uvs_init(&sprite_uvs, sprite_sheet_texture.width, sprite_sheet_texture.height);
+    SpriteBatch sprite_batch;
+    RenderList render_list;
 
     float lastHeight = 0;
     float lastWidth = 0;
 
-    State state = {0};
-    state.status = WAITING;
-    setup(&state, &enemy_types, &player_frames, &destroyable_frames, &sprite_sheet_texture);
+    static Simulation simulation;
+    GameConfig config = game_default_config();
+    uint64_t seed = time(NULL);
+    game_init(&simulation.state, &config, seed);
 
-    Animator player_bullet_animator = {
-        .accumulator = {0},
-        .atlas_definition = &player_bullet_atlas,
-        .current_frame = 0,
-        .texture = &sprite_sheet_texture,
-    };
+    simulation.record_path = headless_options.record_path;
+    if (simulation.record_path != NULL)
+    {
+        replay_recorder_begin(&simulation.recorder, seed, SIMULATION_DT, headless_options.keyframe_interval);
+    }
+
+    // F5 saves, F9 loads and holding backspace steps back a tick at a time. Both would desync a recording, so they
+    // only work when not recording.
+    simulation.can_travel = simulation.record_path == NULL;
+    if (simulation.can_travel && !rewind_init(&simulation.rewind, REWIND_DEFAULT_ARENA_SIZE))
+    {
+        simulation.can_travel = false;
+    }
+    if (simulation.can_travel)
+    {
+        rewind_push(&simulation.rewind, &simulation.state);
+    }
+
+    triple_buffer_init(&simulation.snapshots);
+    publish_snapshot(&simulation, nob_nanos_since_unspecified_epoch());
+    pthread_t simulation_thread;
+    if (pthread_create(&simulation_thread, NULL, run_simulation, &simulation) != 0)
+    {
+        nob_log(NOB_ERROR, "could not start the simulation thread");
+        return 1;
+    }
 
     RenderTexture2D target;
+    // What `target` holds, so the frozen frame behind the end screen is only drawn again when it changes.
+    RenderList target_list;
+    bool target_current = false;
 
     float background_x = 0.f;
     bool background_x_dir = false;
@@ -785,13 +406,25 @@ int main(void)
     float background_y = 0.f;
     bool background_y_dir = false;
 
-    Accumulator time_to_accept_input = {
-        .ms_accumulated = 0,
-        .ms_to_trigger = 1000,
-    };
-
     while (!WindowShouldClose())
     {
+        atomic_store(&simulation.input, read_input());
+        atomic_store(&simulation.rewinding, IsKeyDown(KEY_BACKSPACE));
+        if (IsKeyPressed(KEY_F5))
+        {
+            atomic_store(&simulation.save_requested, true);
+        }
+        if (IsKeyPressed(KEY_F9))
+        {
+            atomic_store(&simulation.load_requested, true);
+        }
+
+        // The newest tick stays ours to draw until the next frame, however many ticks the simulation runs meanwhile.
+        const Snapshot *snapshot = &simulation.slots[triple_buffer_front(&simulation.snapshots)];
+        const State *state = &snapshot->state;
+        float alpha = (float)(nob_nanos_since_unspecified_epoch() - snapshot->tick_ns) / SIMULATION_DT_NS;
+        alpha = fminf(alpha, 1.0f);
+
         BeginDrawing();
         ClearBackground(RAYWHITE);
 
@@ -856,14 +489,18 @@ int main(void)
             lastHeight = height;
             lastWidth = width;
             target = LoadRenderTexture(width, height);
+            target_current = false;
         }
 
-        switch (state.status)
+        // `alpha` is how far rendering is between the previous simulation tick and the current one.
+        render_list_record_game(&render_list, state, alpha, scale, offset);
+
+        switch (state->status)
         {
         case WAITING:
         case PLAYING: {
             {
-                const char *text = nob_temp_sprintf("Score: %d", state.score);
+                const char *text = nob_temp_sprintf("Score: %d", state->score);
                 const size_t font_size = 25;
                 Vector2 text_size = MeasureTextEx(GetFontDefault(), text, font_size, 0);
                 Vector2 position = {
@@ -876,210 +513,10 @@ int main(void)
                          font_size,                    //
                          WHITE);
             }
-            if (state.status == PLAYING)
-            {
-                nob_da_foreach(Enemy, enemy, &state.enemies)
-                {
-                    if (enemy->health <= 0)
-                    {
-                        continue;
-                    }
-
-                    if (accumulator_tick(&enemy->animator.accumulator, GetFrameTime(), When_Tick_Ends_Restart))
-                    {
-                        enemy->animator.current_frame =
-                            (enemy->animator.current_frame + 1) % enemy->animator.atlas_definition->pieces_count;
-                    }
-                }
-
-                if (accumulator_tick(&state.player.animator.accumulator, GetFrameTime(), When_Tick_Ends_Restart))
-                {
-                    state.player.animator.current_frame = (state.player.animator.current_frame + 1) %
-                                                          state.player.animator.atlas_definition->pieces_count;
-                }
-            }
-
-            if (state.status == PLAYING)
-            {
-                nob_da_foreach(Particle, particle, &state.particles)
-                {
-                    if (particle->finished)
-                    {
-                        continue;
-                    }
-
-                    if (accumulator_tick(&particle->animator.accumulator, GetFrameTime(), When_Tick_Ends_Restart))
-                    {
-                        particle->animator.current_frame = particle->animator.current_frame + 1;
-                        if (particle->animator.current_frame >= particle->animator.atlas_definition->pieces_count)
-                        {
-                            particle->finished = true;
-                        }
-                    }
-                }
-            }
-
-            draw_game(&state, scale, offset);
-
-            bool moved = move_player(&state.player.position);
-            if (moved && state.status == WAITING)
-            {
-                state.status = PLAYING;
-            }
-
-            bool reached_wall = false;
-            float enemy_speed = 0.1f * GetFrameTime();
-
-            if (state.status == PLAYING)
-            {
-                handle_player_shooting(&state.player, &player_bullet_animator);
-
-                nob_da_foreach(Enemy, enemy, &state.enemies)
-                {
-                    if (enemy->health <= 0)
-                    {
-                        continue;
-                    }
-
-                    Vector2 new_position = (Vector2){
-                        .x = enemy->position.x + (state.enemies_going_right ? enemy_speed : -enemy_speed),
-                        .y = enemy->position.y,
-                    };
-
-                    if (new_position.x < 0 || new_position.x > COLUMNS)
-                    {
-                        reached_wall = true;
-                        break;
-                    }
-                }
-
-                if (reached_wall)
-                {
-                    state.enemies_going_right = !state.enemies_going_right;
-                }
-
-                nob_da_foreach(Enemy, enemy, &state.enemies)
-                {
-                    if (enemy->health <= 0)
-                    {
-                        continue;
-                    }
-
-                    enemy->position = (Vector2){
-                        .x = enemy->position.x + (state.enemies_going_right ? enemy_speed : -enemy_speed),
-                        .y = enemy->position.y + (reached_wall ? 0.05f : 0.0f),
-                    };
-                }
-
-                nob_da_foreach(Enemy, enemy, &state.enemies)
-                {
-                    if (enemy->health <= 0)
-                    {
-                        continue;
-                    }
-
-                    if (enemy->position.y >= ENEMIES_GAME_OVER_ROW)
-                    {
-                        state.status = LOST;
-                        break;
-                    }
-                }
-
-                nob_da_foreach(Enemy, enemy, &state.enemies)
-                {
-                    if (enemy->health <= 0)
-                    {
-                        continue;
-                    }
-
-                    if (accumulator_tick(&enemy->shooting.accumulator, GetFrameTime(), When_Tick_Ends_Restart))
-                    {
-                        Bullet bullet = {
-                            .position =
-                                {
-                                    .x = enemy->position.x + ENEMY_SIZE.x / 2,
-                                    .y = enemy->position.y + ENEMY_SIZE.y,
-                                },
-                            .timing =
-                                {
-                                    .ms_accumulated = 0,
-                                    .ms_to_trigger = 200,
-                                },
-                            .animator = enemy->shooting.bullet_animator,
-                        };
-                        nob_da_append(&state.enemy_bullets, bullet);
-                    }
-                }
 
-                {
-                    const Vector2 gravity = {
-                        .x = 0,
-                        .y = 10 * GetFrameTime(),
-                    };
-
-                    nob_da_foreach(Bullet, bullet, &state.enemy_bullets)
-                    {
-                        if (accumulator_tick(&bullet->timing, GetFrameTime(), When_Tick_Ends_Restart))
-                        {
-                            bullet->position = Vector2Add(bullet->position, gravity);
-                        }
-
-                        if (accumulator_tick(&bullet->animator.accumulator, GetFrameTime(), When_Tick_Ends_Restart))
-                        {
-                            bullet->animator.current_frame =
-                                (bullet->animator.current_frame + 1) % bullet->animator.atlas_definition->pieces_count;
-                        }
-                    }
-
-                    if (!state.player.bullet.destroyed)
-                    {
-                        state.player.bullet.position =
-                            Vector2Add(state.player.bullet.position, Vector2Scale(gravity, -1.0f));
-                    }
-                }
+            draw_render_list(&sprite_batch, &sprite_uvs, &render_list, sprite_sheet_texture);
 
-                {
-                    nob_da_foreach(Bullet, bullet, &state.enemy_bullets)
-                    {
-                        if (bullet->position.y > GAME_ROWS)
-                        {
-                            bullet->destroyed = true;
-                            continue;
-                        }
-
-                        HitResult result = {0};
-                        check_collisions(Destroyable, destroyable, &state.destroyables, DESTROYABLE_SIZE, DESTROYABLE,
-                                         main_loop_on_collision);
-                        const struct
-                        {
-                            Player *items;
-                            size_t count;
-                        } player_ = {.items = &state.player, .count = 1};
-
-                        check_collisions(Player, player, &player_, PLAYER_SIZE, PLAYER, main_loop_on_collision);
-
-                    main_loop_on_collision:
-                        if (result.entity_type == PLAYER)
-                        {
-                            state.status = LOST;
-                            break;
-                        }
-                        continue;
-                    }
-
-                    for (int i = state.enemy_bullets.count - 1; i >= 0; --i)
-                    {
-                        Bullet *bullet = &state.enemy_bullets.items[i];
-
-                        if (bullet->destroyed)
-                        {
-                            nob_da_remove_unordered(&state.enemy_bullets, i);
-                        }
-                    }
-                }
-                move_player_bullet(&state, &destroy_explosion_frames, &sprite_sheet_texture);
-            }
-            if (state.status == WAITING)
+            if (state->status == WAITING)
             {
                 const char *text =
                     nob_temp_sprintf("Move with A/D\nor Left/Right arrows.\n Space to shoot.\nMove to start playing.");
@@ -1099,29 +536,22 @@ int main(void)
         }
         case WON:
         case LOST: {
-            BeginTextureMode(target);
-
-            draw_game(&state, scale, offset);
-
-            EndTextureMode();
+            if (!target_current || !render_list_equal(&render_list, &target_list))
+            {
+                BeginTextureMode(target);
+                ClearBackground(BLANK);
+                draw_render_list(&sprite_batch, &sprite_uvs, &render_list, sprite_sheet_texture);
+                EndTextureMode();
+                target_list = render_list;
+                target_current = true;
+            }
             DrawTextureRec(target.texture,
                            (Rectangle){0, 0, (float)target.texture.width, (float)-target.texture.height}, Vector2Zero(),
                            RED);
 
-            if (accumulator_tick(&time_to_accept_input, GetFrameTime(), When_Tick_Ends_Keep))
-            {
-                if (IsKeyDown(KEY_RIGHT) || IsKeyDown(KEY_D) || IsKeyDown(KEY_LEFT) || IsKeyDown(KEY_A))
-                {
-                    accumulator_reset(&time_to_accept_input);
-                    state.status = PLAYING;
-                    setup(&state, &enemy_types, &player_frames, &destroyable_frames, &sprite_sheet_texture);
-                    continue;
-                }
-            }
-
-            const char *text = state.status == LOST
-                                   ? nob_temp_sprintf("Lost. Score: %d\nPress any key to restart", state.score)
-                                   : nob_temp_sprintf("Won. Score: %d\nPress any key to restart", state.score);
+            const char *text = state->status == LOST
+                                   ? nob_temp_sprintf("Lost. Score: %d\nPress any key to restart", state->score)
+                                   : nob_temp_sprintf("Won. Score: %d\nPress any key to restart", state->score);
 
             const size_t font_size = 50;
             Vector2 text_size = MeasureTextEx(GetFontDefault(), text, font_size, 0);
@@ -1146,4 +576,14 @@ int main(void)
 
         nob_temp_reset();
     }
+    atomic_store(&simulation.quit, true);
+    pthread_join(simulation_thread, NULL);
+    rewind_free(&simulation.rewind);
+
+    if (simulation.record_path != NULL && !replay_recorder_finish(&simulation.recorder, simulation.record_path))
+    {
+        return 1;
+    }
+
+    return 0;
 }
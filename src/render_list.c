@@ -0,0 +1,100 @@
+#include "render_list.h"
+#include "nob.h"
+
+typedef struct
+{
+    RenderList *list;
+    float scale;
+    Vector2 offset;
+} Recorder;
+
+static void record(Recorder *recorder, AtlasId atlas, size_t frame, Vector2 world_position, Vector2 world_size)
+{
+    RenderList *list = recorder->list;
+    if (list->count == RENDER_LIST_CAPACITY)
+    {
+        return;
+    }
+
+    list->items[list->count++] = (RenderCommand){
+        .destination =
+            {
+                .x = world_position.x * recorder->scale + recorder->offset.x,
+                .y = world_position.y * recorder->scale + recorder->offset.y,
+                .width = world_size.x * recorder->scale,
+                .height = world_size.y * recorder->scale,
+            },
+        .tint = WHITE,
+        .atlas = atlas,
+        .frame = frame,
+    };
+}
+
+void render_list_record_game(RenderList *list, const State *state, float alpha, float scale, Vector2 offset)
+{
+    list->count = 0;
+    Recorder recorder = {.list = list, .scale = scale, .offset = offset};
+
+    // Static scenery first, its frame showing how worn it is, then the enemies where the formation puts their slots,
+    // then everything that moves on its own, a chunk of columns at a time.
+    const World *world = &state->world;
+    WorldQuery query = world_query(HAS(POSITION) | HAS(ANIMATOR) | HAS(HEALTH), HAS(PREVIOUS_POSITION));
+    for (EntityChunk chunk; entities_next(world, &query, &chunk);)
+    {
+        Vector2 size = game_table_size(chunk.table);
+        for (size_t i = 0; i < chunk.count; ++i)
+        {
+            record(&recorder, chunk.animator[i].atlas, destroyable_frame(chunk.health[i]), chunk.position[i], size);
+        }
+    }
+
+    const Formation *formation = &state->formation;
+    query = world_query(HAS(SLOT) | HAS(ANIMATOR), HAS(POSITION));
+    for (EntityChunk chunk; entities_next(world, &query, &chunk);)
+    {
+        Vector2 size = game_table_size(chunk.table);
+        for (size_t i = 0; i < chunk.count; ++i)
+        {
+            Vector2 position = interpolate_position(enemy_previous_position(formation, chunk.slot[i]),
+                                                    enemy_position(formation, chunk.slot[i]), alpha);
+            record(&recorder, chunk.animator[i].atlas, animator_frame(&chunk.animator[i], state->animation_ns),
+                   position, size);
+        }
+    }
+
+    query = world_query(HAS(POSITION) | HAS(PREVIOUS_POSITION) | HAS(ANIMATOR), 0);
+    for (EntityChunk chunk; entities_next(world, &query, &chunk);)
+    {
+        Vector2 size = game_table_size(chunk.table);
+        for (size_t i = 0; i < chunk.count; ++i)
+        {
+            record(&recorder, chunk.animator[i].atlas, animator_frame(&chunk.animator[i], state->animation_ns),
+                   interpolate_position(chunk.previous_position[i], chunk.position[i], alpha), size);
+        }
+    }
+}
+
+// Field by field, since the padding of a command is not guaranteed to be zero.
+static bool render_command_equal(const RenderCommand *a, const RenderCommand *b)
+{
+    return a->destination.x == b->destination.x && a->destination.y == b->destination.y &&
+           a->destination.width == b->destination.width && a->destination.height == b->destination.height &&
+           a->tint.r == b->tint.r && a->tint.g == b->tint.g && a->tint.b == b->tint.b && a->tint.a == b->tint.a &&
+           a->atlas == b->atlas && a->frame == b->frame;
+}
+
+bool render_list_equal(const RenderList *a, const RenderList *b)
+{
+    if (a->count != b->count)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < a->count; ++i)
+    {
+        if (!render_command_equal(&a->items[i], &b->items[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "game.h"
+#include "raylib.h"
+#include "stdbool.h"
+#include "stddef.h"
+
+// Everything draw_game can show at once.
+#define RENDER_LIST_CAPACITY (MAX_ENEMIES + MAX_ENEMY_BULLETS + MAX_PARTICLES + MAX_DESTROYABLES + 2)
+
+// One sprite to draw, already placed on the screen. Plain data, so a list can be built away from raylib, kept, compared
+// with the last one and replayed later.
+typedef struct
+{
+    Rectangle destination;
+    Color tint;
+    uint8_t atlas; // AtlasId
+    uint8_t frame;
+} RenderCommand;
+
+// The commands of a frame, in drawing order.
+typedef struct
+{
+    RenderCommand items[RENDER_LIST_CAPACITY];
+    size_t count;
+} RenderList;
+
+// Records every sprite of the game, `alpha` of the way from the previous simulation tick to the current one, with the
+// world scaled by `scale` and moved by `offset` on the screen.
+void render_list_record_game(RenderList *, const State *state, float alpha, float scale, Vector2 offset);
+// Whether drawing both lists gives the same picture.
+bool render_list_equal(const RenderList *a, const RenderList *b);
@@ -0,0 +1,850 @@
+#include "replay.h"
+#include "headless.h"
+
+#include "fcntl.h"
+#include "sys/mman.h"
+#include "sys/stat.h"
+#include "unistd.h"
+
+#define REPLAY_HEADER_SIZE (4 + 4 + 8 + 4 + 4)
+#define REPLAY_INDEX_ENTRY_SIZE (4 * 8)
+#define REPLAY_FOOTER_SIZE (4 * 8 + 4)
+
+static void write_u8(Nob_String_Builder *sb, uint8_t value)
+{
+    nob_da_append(sb, (char)value);
+}
+
+static void write_u16(Nob_String_Builder *sb, uint16_t value)
+{
+    write_u8(sb, value);
+    write_u8(sb, value >> 8);
+}
+
+static void write_u32(Nob_String_Builder *sb, uint32_t value)
+{
+    write_u16(sb, value);
+    write_u16(sb, value >> 16);
+}
+
+static void write_u64(Nob_String_Builder *sb, uint64_t value)
+{
+    write_u32(sb, value);
+    write_u32(sb, value >> 32);
+}
+
+static void write_f32(Nob_String_Builder *sb, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    write_u32(sb, bits);
+}
+
+static void write_varint(Nob_String_Builder *sb, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        write_u8(sb, (value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    write_u8(sb, value);
+}
+
+typedef struct
+{
+    const uint8_t *data;
+    size_t size;
+    size_t cursor;
+    bool ok;
+} Reader;
+
+static uint8_t read_u8(Reader *reader)
+{
+    if (reader->cursor >= reader->size)
+    {
+        reader->ok = false;
+        return 0;
+    }
+    return reader->data[reader->cursor++];
+}
+
+static uint16_t read_u16(Reader *reader)
+{
+    uint16_t low = read_u8(reader);
+    return low | (uint16_t)read_u8(reader) << 8;
+}
+
+static uint32_t read_u32(Reader *reader)
+{
+    uint32_t low = read_u16(reader);
+    return low | (uint32_t)read_u16(reader) << 16;
+}
+
+static uint64_t read_u64(Reader *reader)
+{
+    uint64_t low = read_u32(reader);
+    return low | (uint64_t)read_u32(reader) << 32;
+}
+
+static float read_f32(Reader *reader)
+{
+    uint32_t bits = read_u32(reader);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static uint64_t read_varint(Reader *reader)
+{
+    uint64_t value = 0;
+    for (size_t shift = 0; shift < 64 && reader->ok; shift += 7)
+    {
+        uint8_t byte = read_u8(reader);
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return value;
+        }
+    }
+    reader->ok = false;
+    return value;
+}
+
+static void write_vector(Nob_String_Builder *sb, Vector2 vector)
+{
+    write_f32(sb, vector.x);
+    write_f32(sb, vector.y);
+}
+
+static Vector2 read_vector(Reader *reader)
+{
+    float x = read_f32(reader);
+    return (Vector2){.x = x, .y = read_f32(reader)};
+}
+
+static void write_accumulator(Nob_String_Builder *sb, Accumulator accumulator)
+{
+    write_u64(sb, accumulator.ns_to_trigger);
+    write_u64(sb, accumulator.ns_accumulated);
+}
+
+static Accumulator read_accumulator(Reader *reader)
+{
+    uint64_t ns_to_trigger = read_u64(reader);
+    return (Accumulator){.ns_to_trigger = ns_to_trigger, .ns_accumulated = read_u64(reader)};
+}
+
+// Everything with an atlas gets drawn, which looks the atlas up, so a file naming one that does not exist is rejected.
+static uint8_t read_atlas(Reader *reader)
+{
+    uint8_t atlas = read_u8(reader);
+    if (atlas >= ATLAS_COUNT)
+    {
+        reader->ok = false;
+    }
+    return atlas;
+}
+
+static void write_animator(Nob_String_Builder *sb, const Animator *animator)
+{
+    write_u8(sb, animator->atlas);
+    write_u64(sb, animator->phase_ns);
+}
+
+static Animator read_animator(Reader *reader)
+{
+    Animator animator = {0};
+    animator.atlas = read_atlas(reader);
+    animator.phase_ns = read_u64(reader);
+    return animator;
+}
+
+static void write_component(Nob_String_Builder *sb, size_t component, const void *value)
+{
+    switch (component)
+    {
+    case COMPONENT_POSITION:
+    case COMPONENT_PREVIOUS_POSITION:
+        write_vector(sb, *(const Vector2 *)value);
+        break;
+
+    case COMPONENT_ANIMATOR:
+        write_animator(sb, value);
+        break;
+
+    case COMPONENT_TIMING:
+        write_accumulator(sb, *(const Accumulator *)value);
+        break;
+
+    case COMPONENT_HEALTH:
+    case COMPONENT_SLOT:
+    case COMPONENT_BULLET_ATLAS:
+        write_u8(sb, *(const uint8_t *)value);
+        break;
+
+    case COMPONENT_FIRE_INTERVAL:
+        write_u16(sb, *(const uint16_t *)value);
+        break;
+
+    case COMPONENT_FIRE_NEXT:
+        write_u64(sb, *(const uint64_t *)value);
+        break;
+
+    default:
+        NOB_UNREACHABLE("Component was bad?\n");
+    }
+}
+
+// Fails on an atlas that does not exist, or a slot past the formation.
+static void read_component(Reader *reader, size_t component, void *value)
+{
+    switch (component)
+    {
+    case COMPONENT_POSITION:
+    case COMPONENT_PREVIOUS_POSITION:
+        *(Vector2 *)value = read_vector(reader);
+        break;
+
+    case COMPONENT_ANIMATOR:
+        *(Animator *)value = read_animator(reader);
+        break;
+
+    case COMPONENT_TIMING:
+        *(Accumulator *)value = read_accumulator(reader);
+        break;
+
+    case COMPONENT_HEALTH:
+        *(uint8_t *)value = read_u8(reader);
+        break;
+
+    case COMPONENT_SLOT:
+        *(uint8_t *)value = read_u8(reader);
+        reader->ok = reader->ok && *(uint8_t *)value < MAX_ENEMIES;
+        break;
+
+    case COMPONENT_BULLET_ATLAS:
+        *(uint8_t *)value = read_atlas(reader);
+        break;
+
+    case COMPONENT_FIRE_INTERVAL:
+        *(uint16_t *)value = read_u16(reader);
+        break;
+
+    case COMPONENT_FIRE_NEXT:
+        *(uint64_t *)value = read_u64(reader);
+        break;
+
+    default:
+        NOB_UNREACHABLE("Component was bad?\n");
+    }
+}
+
+// The slot map, then table by table the slot of each row and a column at a time. The map reuses freed slots before
+// taking fresh ones in order, so no slot at or past the high water mark was ever used and they all still are as
+// world_init() left them.
+static void write_world(Nob_String_Builder *sb, const World *world)
+{
+    write_u32(sb, world->high_water);
+    write_u16(sb, world->map.free);
+    for (size_t slot = 0; slot < world->high_water; ++slot)
+    {
+        write_u16(sb, world->slots[slot].generation);
+        write_u16(sb, world->slots[slot].index);
+        write_u8(sb, world->table_of[slot]);
+    }
+
+    for (size_t table = 0; table < world->tables_count; ++table)
+    {
+        const Archetype *archetype = &world->tables[table];
+        write_u32(sb, archetype->count);
+        write_u32(sb, archetype->high_water);
+        for (size_t row = 0; row < archetype->count; ++row)
+        {
+            write_u16(sb, world->owners[archetype->first_owner + row]);
+        }
+        for (size_t component = 0; component < world->components_count; ++component)
+        {
+            for (size_t row = 0; (archetype->components & (1u << component)) && row < archetype->count; ++row)
+            {
+                write_component(sb, component, world_get(world, table, component, row));
+            }
+        }
+    }
+}
+
+// Into a world laid out as game_init() lays it out. Fails on slots pointing past the world, and on rows whose slot
+// does not point back at them.
+static bool read_world(Reader *reader, World *world)
+{
+    game_world_init(world);
+    uint32_t high_water = read_u32(reader);
+    if (!reader->ok || high_water > WORLD_MAX_ENTITIES)
+    {
+        return false;
+    }
+    world->high_water = high_water;
+    world->map.free = read_u16(reader);
+    bool ok = world->map.free < WORLD_MAX_ENTITIES || world->map.free == SLOT_MAP_NONE;
+    for (size_t slot = 0; slot < high_water; ++slot)
+    {
+        world->slots[slot].generation = read_u16(reader);
+        world->slots[slot].index = read_u16(reader);
+        world->table_of[slot] = read_u8(reader);
+        ok = ok && (world->slots[slot].index < WORLD_MAX_ENTITIES || world->slots[slot].index == SLOT_MAP_NONE) &&
+             world->table_of[slot] < world->tables_count;
+    }
+    if (!ok || !reader->ok)
+    {
+        return false;
+    }
+
+    for (size_t table = 0; table < world->tables_count; ++table)
+    {
+        Archetype *archetype = &world->tables[table];
+        uint32_t count = read_u32(reader);
+        uint32_t table_high_water = read_u32(reader);
+        if (!reader->ok || count > table_high_water || table_high_water > archetype->capacity)
+        {
+            return false;
+        }
+        archetype->count = count;
+        archetype->high_water = table_high_water;
+        world->live += count;
+        for (size_t row = 0; row < count; ++row)
+        {
+            uint16_t slot = read_u16(reader);
+            if (slot >= high_water || world->slots[slot].index != row || world->table_of[slot] != table)
+            {
+                return false;
+            }
+            world->owners[archetype->first_owner + row] = slot;
+        }
+        for (size_t component = 0; component < world->components_count; ++component)
+        {
+            for (size_t row = 0; (archetype->components & (1u << component)) && row < count; ++row)
+            {
+                read_component(reader, component, world_get(world, table, component, row));
+            }
+        }
+    }
+    return reader->ok && world->live <= high_water;
+}
+
+static void write_state(Nob_String_Builder *sb, const State *state)
+{
+    write_u16(sb, state->config.fire_timer_min_ms);
+    write_u16(sb, state->config.fire_timer_max_ms);
+    write_f32(sb, state->config.enemy_speed);
+    write_u8(sb, state->config.bullet_damage);
+
+    write_accumulator(sb, state->time_to_accept_input);
+    write_u64(sb, state->animation_ns);
+    write_u64(sb, state->rng.state);
+    write_u64(sb, state->rng.increment);
+    write_u16(sb, state->score);
+    write_u8(sb, state->status);
+
+    write_world(sb, &state->world);
+    write_u16(sb, state->oldest_particle);
+
+    const Formation *formation = &state->formation;
+    write_vector(sb, formation->origin);
+    write_vector(sb, formation->previous_origin);
+    write_u8(sb, formation->going_right);
+    write_u8(sb, formation->fire_scheduled);
+    for (size_t row = 0; row < ENEMY_ROWS; ++row)
+    {
+        write_u64(sb, formation->alive[row]);
+    }
+    // Only when each timer is due, the wheel is rebuilt from that when reading.
+    write_u32(sb, state->timers.wheel.now);
+    write_u64(sb, state->timers.now_ns);
+    for (size_t i = 0; i < MAX_ENEMIES; ++i)
+    {
+        write_u32(sb, formation->members[i]);
+        bool scheduled = timer_wheel_scheduled(state->timers.nodes, i);
+        write_u8(sb, scheduled);
+        write_u32(sb, scheduled ? state->timers.nodes[i].due : 0);
+    }
+
+    write_u32(sb, state->events.count);
+    nob_da_foreach(const GameEvent, event, &state->events)
+    {
+        write_u8(sb, event->kind);
+        write_u32(sb, event->target);
+        write_u32(sb, event->bullet);
+    }
+}
+
+// Whether every live slot of the formation has its enemy, and only those, as ticking looks enemies up by slot.
+static bool formation_matches(const State *state)
+{
+    const Formation *formation = &state->formation;
+    const World *world = &state->world;
+    for (size_t slot = 0; slot < MAX_ENEMIES; ++slot)
+    {
+        bool alive = formation->alive[slot / COLUMNS] & (1ull << (slot % COLUMNS));
+        size_t row = 0;
+        bool found = world_find_in(world, formation->members[slot], TABLE_ENEMIES, &row);
+        if (alive != found || (found && *entity_slot(world, TABLE_ENEMIES, row) != slot) ||
+            (!alive && timer_wheel_scheduled(state->timers.nodes, slot)))
+        {
+            return false;
+        }
+    }
+    return enemies_alive(state) == world->tables[TABLE_ENEMIES].count;
+}
+
+static bool read_state(Reader *reader, State *state)
+{
+    state->config.fire_timer_min_ms = read_u16(reader);
+    state->config.fire_timer_max_ms = read_u16(reader);
+    state->config.enemy_speed = read_f32(reader);
+    state->config.bullet_damage = read_u8(reader);
+
+    state->time_to_accept_input = read_accumulator(reader);
+    state->animation_ns = read_u64(reader);
+    state->rng.state = read_u64(reader);
+    state->rng.increment = read_u64(reader);
+    state->score = read_u16(reader);
+    state->status = read_u8(reader);
+
+    if (!read_world(reader, &state->world) || state->world.tables[TABLE_PLAYER].count != 1)
+    {
+        return false;
+    }
+    // Only a full table of particles has its oldest anywhere but first.
+    const Archetype *particles = &state->world.tables[TABLE_PARTICLES];
+    state->oldest_particle = read_u16(reader);
+    if (state->oldest_particle != 0 &&
+        (particles->count < particles->capacity || state->oldest_particle >= particles->count))
+    {
+        return false;
+    }
+
+    Formation *formation = &state->formation;
+    formation->origin = read_vector(reader);
+    formation->previous_origin = read_vector(reader);
+    formation->going_right = read_u8(reader);
+    formation->fire_scheduled = read_u8(reader);
+    uint64_t stray_columns = 0;
+    for (size_t row = 0; row < ENEMY_ROWS; ++row)
+    {
+        formation->alive[row] = read_u64(reader);
+        stray_columns |= formation->alive[row] >> (COLUMNS - 1) >> 1;
+    }
+    Timers *timers = &state->timers;
+    timer_wheel_init(&timers->wheel, timers->nodes, MAX_TIMERS);
+    timers->wheel.now = read_u32(reader);
+    timers->now_ns = read_u64(reader);
+    for (size_t i = 0; i < MAX_ENEMIES; ++i)
+    {
+        formation->members[i] = read_u32(reader);
+        bool scheduled = read_u8(reader);
+        uint32_t due = read_u32(reader);
+        if (scheduled)
+        {
+            timer_wheel_schedule(&timers->wheel, timers->nodes, i, due, TIMER_ENEMY_FIRE);
+        }
+    }
+    if (!reader->ok || stray_columns != 0 || !formation_matches(state))
+    {
+        return false;
+    }
+
+    uint32_t count = read_u32(reader);
+    if (!reader->ok || count > NOB_ARRAY_LEN(state->events.items))
+    {
+        return false;
+    }
+    state->events.count = count;
+    nob_da_foreach(GameEvent, event, &state->events)
+    {
+        event->kind = read_u8(reader);
+        event->target = read_u32(reader);
+        event->bullet = read_u32(reader);
+        if (event->kind >= EVENT_KIND_COUNT)
+        {
+            return false;
+        }
+    }
+
+    return reader->ok;
+}
+
+static void flush_run(ReplayRecorder *recorder)
+{
+    if (recorder->run_length > 0)
+    {
+        write_u8(&recorder->inputs, recorder->run_input);
+        write_varint(&recorder->inputs, recorder->run_length);
+        recorder->run_length = 0;
+    }
+}
+
+void replay_recorder_begin(ReplayRecorder *recorder, uint64_t seed, float dt, uint32_t keyframe_interval)
+{
+    *recorder = (ReplayRecorder){
+        .seed = seed,
+        .dt = dt,
+        .keyframe_interval = keyframe_interval > 0 ? keyframe_interval : REPLAY_DEFAULT_KEYFRAME_INTERVAL,
+    };
+}
+
+void replay_recorder_tick(ReplayRecorder *recorder, const State *state, uint8_t input)
+{
+    if (recorder->tick % recorder->keyframe_interval == 0)
+    {
+        // Runs never cross a keyframe so playback can start decoding right at it.
+        flush_run(recorder);
+
+        size_t keyframe_offset = recorder->keyframes.count;
+        write_state(&recorder->keyframes, state);
+
+        nob_da_append(&recorder->index, ((ReplayKeyframe){
+                                            .tick = recorder->tick,
+                                            .input_offset = REPLAY_HEADER_SIZE + recorder->inputs.count,
+                                            .keyframe_offset = keyframe_offset,
+                                            .keyframe_size = recorder->keyframes.count - keyframe_offset,
+                                        }));
+    }
+
+    if (recorder->run_length > 0 && recorder->run_input != input)
+    {
+        flush_run(recorder);
+    }
+    recorder->run_input = input;
+    recorder->run_length += 1;
+    recorder->tick += 1;
+}
+
+bool replay_recorder_finish(ReplayRecorder *recorder, const char *path)
+{
+    flush_run(recorder);
+
+    Nob_String_Builder file = {0};
+    nob_sb_append_buf(&file, REPLAY_MAGIC, 4);
+    write_u32(&file, REPLAY_VERSION);
+    write_u64(&file, recorder->seed);
+    write_f32(&file, recorder->dt);
+    write_u32(&file, recorder->keyframe_interval);
+    assert(file.count == REPLAY_HEADER_SIZE);
+
+    nob_sb_append_buf(&file, recorder->inputs.items, recorder->inputs.count);
+    uint64_t inputs_end = file.count;
+
+    nob_sb_append_buf(&file, recorder->keyframes.items, recorder->keyframes.count);
+
+    uint64_t index_offset = file.count;
+    nob_da_foreach(ReplayKeyframe, keyframe, &recorder->index)
+    {
+        write_u64(&file, keyframe->tick);
+        write_u64(&file, keyframe->input_offset);
+        write_u64(&file, inputs_end + keyframe->keyframe_offset);
+        write_u64(&file, keyframe->keyframe_size);
+    }
+
+    write_u64(&file, recorder->tick);
+    write_u64(&file, inputs_end);
+    write_u64(&file, index_offset);
+    write_u64(&file, recorder->index.count);
+    nob_sb_append_buf(&file, REPLAY_MAGIC, 4);
+
+    bool written = nob_write_entire_file(path, file.items, file.count);
+    if (written)
+    {
+        nob_log(NOB_INFO, "recorded %llu ticks with %zu keyframes to %s (%zu bytes)",
+                (unsigned long long)recorder->tick, recorder->index.count, path, file.count);
+    }
+
+    nob_sb_free(file);
+    nob_sb_free(recorder->inputs);
+    nob_sb_free(recorder->keyframes);
+    nob_da_free(recorder->index);
+    *recorder = (ReplayRecorder){0};
+    return written;
+}
+
+bool replay_open(Replay *replay, const char *path)
+{
+    *replay = (Replay){0};
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        nob_log(NOB_ERROR, "could not open replay %s: %s", path, strerror(errno));
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) < 0)
+    {
+        nob_log(NOB_ERROR, "could not stat replay %s: %s", path, strerror(errno));
+        close(fd);
+        return false;
+    }
+
+    if ((size_t)info.st_size < REPLAY_HEADER_SIZE + REPLAY_FOOTER_SIZE)
+    {
+        nob_log(NOB_ERROR, "%s is too small to be a replay", path);
+        close(fd);
+        return false;
+    }
+
+    void *data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        nob_log(NOB_ERROR, "could not map replay %s: %s", path, strerror(errno));
+        return false;
+    }
+
+    replay->data = data;
+    replay->size = info.st_size;
+
+    Reader header = {.data = replay->data, .size = replay->size, .cursor = 4, .ok = true};
+    uint32_t version = read_u32(&header);
+    replay->seed = read_u64(&header);
+    replay->dt = read_f32(&header);
+    replay->keyframe_interval = read_u32(&header);
+
+    Reader footer = {
+        .data = replay->data,
+        .size = replay->size,
+        .cursor = replay->size - REPLAY_FOOTER_SIZE,
+        .ok = true,
+    };
+    replay->ticks = read_u64(&footer);
+    replay->inputs_end = read_u64(&footer);
+    uint64_t index_offset = read_u64(&footer);
+    replay->keyframes_count = read_u64(&footer);
+
+    if (memcmp(replay->data, REPLAY_MAGIC, 4) != 0 || memcmp(replay->data + replay->size - 4, REPLAY_MAGIC, 4) != 0 ||
+        version != REPLAY_VERSION || replay->keyframe_interval == 0 || replay->inputs_end > index_offset ||
+        index_offset > replay->size - REPLAY_FOOTER_SIZE ||
+        replay->keyframes_count != (replay->size - REPLAY_FOOTER_SIZE - index_offset) / REPLAY_INDEX_ENTRY_SIZE)
+    {
+        nob_log(NOB_ERROR, "%s is not a valid version %d replay", path, REPLAY_VERSION);
+        replay_close(replay);
+        return false;
+    }
+
+    replay->index = replay->data + index_offset;
+    return true;
+}
+
+void replay_close(Replay *replay)
+{
+    if (replay->data != NULL)
+    {
+        munmap(replay->data, replay->size);
+    }
+    *replay = (Replay){0};
+}
+
+static ReplayKeyframe replay_keyframe(const Replay *replay, size_t index)
+{
+    Reader reader = {
+        .data = replay->index + index * REPLAY_INDEX_ENTRY_SIZE,
+        .size = REPLAY_INDEX_ENTRY_SIZE,
+        .ok = true,
+    };
+    ReplayKeyframe keyframe = {0};
+    keyframe.tick = read_u64(&reader);
+    keyframe.input_offset = read_u64(&reader);
+    keyframe.keyframe_offset = read_u64(&reader);
+    keyframe.keyframe_size = read_u64(&reader);
+    return keyframe;
+}
+
+// Its inputs start within the input runs, so playing it never decodes keyframe or index bytes as inputs.
+static bool keyframe_in_bounds(const Replay *replay, ReplayKeyframe keyframe)
+{
+    return keyframe.keyframe_offset <= replay->size &&
+           keyframe.keyframe_size <= replay->size - keyframe.keyframe_offset &&
+           keyframe.input_offset <= replay->inputs_end;
+}
+
+bool replay_next_input(ReplayCursor *cursor, uint8_t *input)
+{
+    if (cursor->remaining == 0)
+    {
+        if (cursor->offset >= cursor->end)
+        {
+            return false;
+        }
+
+        Reader reader = {.data = cursor->replay->data, .size = cursor->end, .cursor = cursor->offset, .ok = true};
+        cursor->input = read_u8(&reader);
+        cursor->remaining = read_varint(&reader);
+        if (!reader.ok || cursor->remaining == 0)
+        {
+            cursor->offset = cursor->end;
+            cursor->remaining = 0;
+            return false;
+        }
+        cursor->offset = reader.cursor;
+    }
+
+    cursor->remaining -= 1;
+    cursor->tick += 1;
+    *input = cursor->input;
+    return true;
+}
+
+bool replay_seek(const Replay *replay, State *state, uint64_t tick, ReplayCursor *cursor)
+{
+    if (replay->keyframes_count == 0)
+    {
+        nob_log(NOB_ERROR, "replay has no keyframes");
+        return false;
+    }
+
+    if (tick > replay->ticks)
+    {
+        tick = replay->ticks;
+    }
+
+    size_t index = tick / replay->keyframe_interval;
+    if (index >= replay->keyframes_count)
+    {
+        index = replay->keyframes_count - 1;
+    }
+
+    ReplayKeyframe keyframe = replay_keyframe(replay, index);
+    if (!keyframe_in_bounds(replay, keyframe) || keyframe.tick > tick)
+    {
+        nob_log(NOB_ERROR, "replay keyframe %zu is corrupt", index);
+        return false;
+    }
+
+    Reader reader = {
+        .data = replay->data + keyframe.keyframe_offset,
+        .size = keyframe.keyframe_size,
+        .ok = true,
+    };
+    if (!read_state(&reader, state))
+    {
+        nob_log(NOB_ERROR, "could not read replay keyframe %zu", index);
+        return false;
+    }
+
+    *cursor = (ReplayCursor){
+        .replay = replay,
+        .offset = keyframe.input_offset,
+        .end = replay->inputs_end,
+        .tick = keyframe.tick,
+    };
+
+    while (cursor->tick < tick)
+    {
+        uint8_t input;
+        if (!replay_next_input(cursor, &input))
+        {
+            nob_log(NOB_ERROR, "replay inputs end before tick %llu", (unsigned long long)tick);
+            return false;
+        }
+        game_update(state, input, replay->dt);
+    }
+
+    return true;
+}
+
+bool replay_verify(const Replay *replay)
+{
+    State state = {0};
+    ReplayCursor cursor = {0};
+    Nob_String_Builder simulated = {0};
+    bool result = true;
+
+    if (!replay_seek(replay, &state, 0, &cursor))
+    {
+        nob_return_defer(false);
+    }
+
+    for (size_t i = 1; i < replay->keyframes_count; ++i)
+    {
+        ReplayKeyframe keyframe = replay_keyframe(replay, i);
+        if (!keyframe_in_bounds(replay, keyframe))
+        {
+            nob_log(NOB_ERROR, "replay keyframe %zu is corrupt", i);
+            nob_return_defer(false);
+        }
+
+        while (cursor.tick < keyframe.tick)
+        {
+            uint8_t input;
+            if (!replay_next_input(&cursor, &input))
+            {
+                nob_log(NOB_ERROR, "replay inputs end before keyframe %zu", i);
+                nob_return_defer(false);
+            }
+            game_update(&state, input, replay->dt);
+        }
+
+        simulated.count = 0;
+        write_state(&simulated, &state);
+        if (simulated.count != keyframe.keyframe_size ||
+            memcmp(simulated.items, replay->data + keyframe.keyframe_offset, simulated.count) != 0)
+        {
+            nob_log(NOB_ERROR, "simulation diverged from the recording before tick %llu",
+                    (unsigned long long)keyframe.tick);
+            nob_return_defer(false);
+        }
+    }
+
+    nob_log(NOB_INFO, "replay matches the simulation at all %zu keyframes", replay->keyframes_count);
+
+defer:
+    nob_sb_free(simulated);
+    return result;
+}
+
+int run_replay(const ReplayOptions *options)
+{
+    Replay replay = {0};
+    if (!replay_open(&replay, options->path))
+    {
+        return 1;
+    }
+
+    int result = 0;
+
+    printf("replay:            %s\n", options->path);
+    printf("seed:              %llu\n", (unsigned long long)replay.seed);
+    printf("ticks:             %llu (%zu keyframes every %u ticks)\n", (unsigned long long)replay.ticks,
+           replay.keyframes_count, replay.keyframe_interval);
+
+    if (options->verify && !replay_verify(&replay))
+    {
+        result = 1;
+    }
+
+    State state = {0};
+    ReplayCursor cursor = {0};
+    uint64_t start = nob_nanos_since_unspecified_epoch();
+
+    if (!replay_seek(&replay, &state, options->seek ? options->seek_tick : 0, &cursor))
+    {
+        result = 1;
+    }
+    else if (!options->seek)
+    {
+        uint8_t input;
+        while (replay_next_input(&cursor, &input))
+        {
+            game_update(&state, input, replay.dt);
+        }
+    }
+
+    uint64_t elapsed = nob_nanos_since_unspecified_epoch() - start;
+
+    if (result == 0)
+    {
+        printf("played to tick:    %llu in %.3f ms\n", (unsigned long long)cursor.tick, elapsed / 1e6);
+        headless_print_state(&state);
+    }
+
+    replay_close(&replay);
+    return result;
+}
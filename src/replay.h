@@ -0,0 +1,95 @@
+#pragma once
+
+#include "game.h"
+#include "nob.h"
+
+// Replay files hold the seed and every tick's input, run length encoded as (input byte, LEB128 run length) pairs.
+// Every `keyframe_interval` ticks the full State is stored too, and an index at the end of the file points at each
+// keyframe and at the input run that starts on its tick, so playback can start from any keyframe.
+//
+//     header | input runs | keyframes | index | footer
+#define REPLAY_MAGIC "RIRP"
+#define REPLAY_VERSION 18
+#define REPLAY_DEFAULT_KEYFRAME_INTERVAL (10 * SIMULATION_TICK_RATE)
+
+typedef struct
+{
+    uint64_t tick;
+    uint64_t input_offset;
+    uint64_t keyframe_offset;
+    uint64_t keyframe_size;
+} ReplayKeyframe;
+
+typedef struct
+{
+    ReplayKeyframe *items;
+    size_t count;
+    size_t capacity;
+} ReplayKeyframes;
+
+typedef struct
+{
+    uint64_t seed;
+    float dt;
+    uint32_t keyframe_interval;
+
+    Nob_String_Builder inputs;
+    Nob_String_Builder keyframes;
+    ReplayKeyframes index;
+
+    uint64_t tick;
+    uint8_t run_input;
+    uint64_t run_length;
+} ReplayRecorder;
+
+void replay_recorder_begin(ReplayRecorder *, uint64_t seed, float dt, uint32_t keyframe_interval);
+// Call right before every game_update() with the state about to be updated and the input it will get.
+void replay_recorder_tick(ReplayRecorder *, const State *state, uint8_t input);
+bool replay_recorder_finish(ReplayRecorder *, const char *path);
+
+typedef struct
+{
+    uint8_t *data;
+    size_t size;
+
+    uint64_t seed;
+    float dt;
+    uint32_t keyframe_interval;
+    uint64_t ticks;
+    // Where the input runs end, from the footer.
+    uint64_t inputs_end;
+
+    const uint8_t *index;
+    size_t keyframes_count;
+} Replay;
+
+// Reads the input runs of a replay one tick at a time.
+typedef struct
+{
+    const Replay *replay;
+    size_t offset;
+    size_t end;
+    uint8_t input;
+    uint64_t remaining;
+    uint64_t tick;
+} ReplayCursor;
+
+bool replay_open(Replay *, const char *path);
+void replay_close(Replay *);
+
+// Restores the keyframe at or before `tick` and simulates the remaining ticks, which is at most one keyframe interval.
+bool replay_seek(const Replay *, State *state, uint64_t tick, ReplayCursor *cursor);
+// Returns false once the recording is over.
+bool replay_next_input(ReplayCursor *, uint8_t *input);
+// Plays the whole replay from its first keyframe and checks every later keyframe against the simulation.
+bool replay_verify(const Replay *);
+
+typedef struct
+{
+    const char *path;
+    uint64_t seek_tick;
+    bool seek;
+    bool verify;
+} ReplayOptions;
+
+int run_replay(const ReplayOptions *options);
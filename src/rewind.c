@@ -0,0 +1,228 @@
+#include "rewind.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define STATE_WORDS (sizeof(State) / sizeof(uint64_t))
+
+_Static_assert(sizeof(State) % sizeof(uint64_t) == 0, "State is XORed a word at a time");
+
+// Worst case of encode_delta(): every other word changed, two varints per changed word.
+#define MAX_DELTA_SIZE (STATE_WORDS * (sizeof(uint64_t) + 2 * 3))
+
+static size_t write_varint(uint8_t *out, size_t value)
+{
+    size_t size = 0;
+    while (value >= 0x80)
+    {
+        out[size++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    out[size++] = value;
+    return size;
+}
+
+static size_t read_varint(const uint8_t *in, size_t *value)
+{
+    size_t size = 0;
+    size_t shift = 0;
+    *value = 0;
+    while (true)
+    {
+        uint8_t byte = in[size++];
+        *value |= (size_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return size;
+        }
+        shift += 7;
+    }
+}
+
+// Encodes `a ^ b` as (unchanged words, changed words, changed words' XOR...) groups.
+static size_t encode_delta(uint8_t *out, const uint64_t *a, const uint64_t *b)
+{
+    size_t size = 0;
+    size_t i = 0;
+    while (i < STATE_WORDS)
+    {
+        size_t same_start = i;
+        while (i < STATE_WORDS && a[i] == b[i])
+        {
+            i += 1;
+        }
+
+        size_t changed_start = i;
+        while (i < STATE_WORDS && a[i] != b[i])
+        {
+            i += 1;
+        }
+
+        if (changed_start == STATE_WORDS)
+        {
+            break;
+        }
+
+        size += write_varint(out + size, changed_start - same_start);
+        size += write_varint(out + size, i - changed_start);
+        for (size_t j = changed_start; j < i; ++j)
+        {
+            uint64_t word = a[j] ^ b[j];
+            memcpy(out + size, &word, sizeof(word));
+            size += sizeof(word);
+        }
+    }
+
+    // An empty group for identical states keeps every delta at least one byte long, see reserve().
+    if (size == 0)
+    {
+        size += write_varint(out + size, 0);
+        size += write_varint(out + size, 0);
+    }
+    return size;
+}
+
+static void apply_delta(uint64_t *words, const uint8_t *in, size_t size)
+{
+    size_t cursor = 0;
+    size_t i = 0;
+    while (cursor < size)
+    {
+        size_t same = 0;
+        size_t changed = 0;
+        cursor += read_varint(in + cursor, &same);
+        cursor += read_varint(in + cursor, &changed);
+        i += same;
+        for (size_t j = 0; j < changed; ++j, ++i)
+        {
+            uint64_t word;
+            memcpy(&word, in + cursor, sizeof(word));
+            words[i] ^= word;
+            cursor += sizeof(word);
+        }
+    }
+}
+
+bool rewind_init(Rewind *rewind, size_t arena_size)
+{
+    memset(rewind, 0, sizeof(*rewind));
+    if (arena_size < MAX_DELTA_SIZE)
+    {
+        arena_size = MAX_DELTA_SIZE;
+    }
+    // One spare delta at the end so encoding never has to check for space.
+    rewind->arena = malloc(arena_size + MAX_DELTA_SIZE);
+    rewind->arena_size = arena_size;
+    return rewind->arena != NULL;
+}
+
+void rewind_free(Rewind *rewind)
+{
+    free(rewind->arena);
+    memset(rewind, 0, sizeof(*rewind));
+}
+
+void rewind_clear(Rewind *rewind)
+{
+    rewind->has_latest = false;
+    rewind->first = 0;
+    rewind->count = 0;
+}
+
+static RewindDelta *delta_at(Rewind *rewind, size_t index)
+{
+    return &rewind->deltas[(rewind->first + index) % REWIND_CAPACITY];
+}
+
+static void drop_oldest(Rewind *rewind)
+{
+    rewind->first = (rewind->first + 1) % REWIND_CAPACITY;
+    rewind->count -= 1;
+}
+
+// Where the next delta goes: right after the newest one, or back at the start of the arena when that would run into
+// the end, as long as it does not run into the oldest delta still kept. Deltas are never empty, so the newest one
+// starting before the oldest one means the ring has wrapped.
+static size_t reserve(Rewind *rewind, size_t size)
+{
+    while (rewind->count > 0)
+    {
+        size_t oldest = delta_at(rewind, 0)->offset;
+        const RewindDelta *newest = delta_at(rewind, rewind->count - 1);
+        size_t end = newest->offset + newest->size;
+
+        if (rewind->count < REWIND_CAPACITY)
+        {
+            if (newest->offset < oldest)
+            {
+                if (end + size <= oldest)
+                {
+                    return end;
+                }
+            }
+            else if (end + size <= rewind->arena_size)
+            {
+                return end;
+            }
+            else if (size <= oldest)
+            {
+                return 0;
+            }
+        }
+
+        drop_oldest(rewind);
+    }
+    return 0;
+}
+
+void rewind_push(Rewind *rewind, const State *state)
+{
+    if (!rewind->has_latest)
+    {
+        memcpy(&rewind->latest, state, sizeof(State));
+        rewind->has_latest = true;
+        return;
+    }
+
+    // Encode into the spare space past the arena first; the size decides where the delta finally goes.
+    uint8_t *scratch = rewind->arena + rewind->arena_size;
+    size_t size = encode_delta(scratch, (const uint64_t *)state, (const uint64_t *)&rewind->latest);
+
+    size_t offset = reserve(rewind, size);
+    memmove(rewind->arena + offset, scratch, size);
+
+    *delta_at(rewind, rewind->count) = (RewindDelta){.offset = offset, .size = size};
+    rewind->count += 1;
+
+    memcpy(&rewind->latest, state, sizeof(State));
+}
+
+bool rewind_pop(Rewind *rewind, State *state)
+{
+    if (!rewind->has_latest)
+    {
+        return false;
+    }
+
+    if (rewind->count == 0)
+    {
+        memcpy(state, &rewind->latest, sizeof(State));
+        return false;
+    }
+
+    const RewindDelta *delta = delta_at(rewind, rewind->count - 1);
+    apply_delta((uint64_t *)&rewind->latest, rewind->arena + delta->offset, delta->size);
+    rewind->count -= 1;
+
+    memcpy(state, &rewind->latest, sizeof(State));
+    return true;
+}
+
+size_t rewind_bytes_used(const Rewind *rewind)
+{
+    size_t bytes = 0;
+    for (size_t i = 0; i < rewind->count; ++i)
+    {
+        bytes += rewind->deltas[(rewind->first + i) % REWIND_CAPACITY].size;
+    }
+    return bytes;
+}
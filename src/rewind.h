@@ -0,0 +1,39 @@
+#pragma once
+
+#include "game.h"
+
+#define REWIND_SECONDS 10
+#define REWIND_CAPACITY (REWIND_SECONDS * SIMULATION_TICK_RATE)
+#define REWIND_DEFAULT_ARENA_SIZE (1024 * 1024)
+
+typedef struct
+{
+    size_t offset;
+    size_t size;
+} RewindDelta;
+
+// Keeps the last REWIND_CAPACITY snapshots of a State. Only the newest one is stored in full; every older one is kept
+// as the XOR of it with its successor, encoded as runs of unchanged and changed 8 byte words, so a tick that moved a
+// handful of things costs a handful of bytes. Deltas live in a byte ring and the oldest ones are dropped when either
+// the ring or the arena is full.
+typedef struct
+{
+    State latest;
+    bool has_latest;
+
+    RewindDelta deltas[REWIND_CAPACITY];
+    size_t first;
+    size_t count;
+
+    uint8_t *arena;
+    size_t arena_size;
+} Rewind;
+
+bool rewind_init(Rewind *, size_t arena_size);
+void rewind_free(Rewind *);
+void rewind_clear(Rewind *);
+// Call once per tick after the update.
+void rewind_push(Rewind *, const State *state);
+// Steps one tick back into `state`, returning false when there is nothing older left.
+bool rewind_pop(Rewind *, State *state);
+size_t rewind_bytes_used(const Rewind *);
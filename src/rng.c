@@ -0,0 +1,43 @@
+#include "rng.h"
+
+void rng_seed(Rng *rng, uint64_t seed)
+{
+    rng->state = 0;
+    rng->increment = (seed << 1) | 1;
+    rng_next(rng);
+    rng->state += seed;
+    rng_next(rng);
+}
+
+uint32_t rng_next(Rng *rng)
+{
+    uint64_t old_state = rng->state;
+    rng->state = old_state * 6364136223846793005ULL + rng->increment;
+    uint32_t xorshifted = ((old_state >> 18u) ^ old_state) >> 27u;
+    uint32_t rotation = old_state >> 59u;
+    return (xorshifted >> rotation) | (xorshifted << ((-rotation) & 31));
+}
+
+int32_t rng_range(Rng *rng, int32_t min, int32_t max)
+{
+    uint32_t range = (uint32_t)(max - min) + 1;
+    if (range == 0)
+    {
+        return (int32_t)rng_next(rng);
+    }
+
+    // Lemire's multiply-shift with rejection keeps the result unbiased without a division on the common path.
+    uint64_t product = (uint64_t)rng_next(rng) * range;
+    uint32_t low = (uint32_t)product;
+    if (low < range)
+    {
+        uint32_t threshold = -range % range;
+        while (low < threshold)
+        {
+            product = (uint64_t)rng_next(rng) * range;
+            low = (uint32_t)product;
+        }
+    }
+
+    return min + (int32_t)(product >> 32);
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "stdint.h"
+
+// PCG32 (https://www.pcg-random.org). Every game owns one so runs are reproducible from their seed alone.
+typedef struct
+{
+    uint64_t state;
+    uint64_t increment;
+} Rng;
+
+void rng_seed(Rng *, uint64_t seed);
+uint32_t rng_next(Rng *);
+// Uniform integer in [min, max], both inclusive.
+int32_t rng_range(Rng *, int32_t min, int32_t max);
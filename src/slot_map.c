@@ -0,0 +1,65 @@
+#include "slot_map.h"
+
+static Handle make_handle(uint16_t generation, uint16_t slot)
+{
+    return (Handle)generation << 16 | slot;
+}
+
+void slot_map_init(SlotMap *map, SlotMapSlot *slots, size_t capacity)
+{
+    map->capacity = capacity;
+    map->free = capacity > 0 ? 0 : SLOT_MAP_NONE;
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        slots[i] = (SlotMapSlot){.generation = 1, .index = i + 1 < capacity ? i + 1 : SLOT_MAP_NONE};
+    }
+}
+
+Handle slot_map_insert(SlotMap *map, SlotMapSlot *slots, uint16_t *owners, size_t index)
+{
+    uint16_t slot = map->free;
+    if (slot == SLOT_MAP_NONE)
+    {
+        return HANDLE_NONE;
+    }
+
+    map->free = slots[slot].index;
+    slots[slot].index = index;
+    owners[index] = slot;
+    return make_handle(slots[slot].generation, slot);
+}
+
+bool slot_map_find(const SlotMap *map, const SlotMapSlot *slots, Handle handle, size_t *index)
+{
+    uint16_t slot = handle & 0xFFFF;
+    if (slot >= map->capacity || slots[slot].generation != handle >> 16)
+    {
+        return false;
+    }
+    *index = slots[slot].index;
+    return true;
+}
+
+Handle slot_map_handle(const SlotMapSlot *slots, const uint16_t *owners, size_t index)
+{
+    uint16_t slot = owners[index];
+    return make_handle(slots[slot].generation, slot);
+}
+
+void slot_map_remove(SlotMap *map, SlotMapSlot *slots, uint16_t *owners, size_t index, size_t last)
+{
+    uint16_t slot = owners[index];
+
+    uint16_t moved = owners[last];
+    owners[index] = moved;
+    slots[moved].index = index;
+
+    // Skipping 0 on wrap keeps HANDLE_NONE from ever matching.
+    slots[slot].generation += 1;
+    if (slots[slot].generation == 0)
+    {
+        slots[slot].generation = 1;
+    }
+    slots[slot].index = map->free;
+    map->free = slot;
+}
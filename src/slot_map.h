@@ -0,0 +1,44 @@
+#pragma once
+
+#include "stdbool.h"
+#include "stddef.h"
+#include "stdint.h"
+
+// Generational handles to the items of a dense array. The array keeps its items packed so loops over them never skip
+// holes, and removing one still swaps the last item into its place, while a handle keeps naming the same item wherever
+// it moves until that item is removed. Inserting, removing and finding are O(1).
+//
+// A handle is a slot index in its low 16 bits and the slot's generation in its high 16 bits. Slots are plain data in
+// arrays owned by the caller, next to the dense items, so a map can live in State and be copied. Freeing a slot bumps
+// its generation, so handles to what it held before stop matching instead of naming whatever comes next.
+typedef uint32_t Handle;
+
+// Never handed out, generations start at 1.
+#define HANDLE_NONE 0
+#define SLOT_MAP_NONE UINT16_MAX
+
+typedef struct
+{
+    uint16_t generation;
+    // Where the slot's item is in the dense array while the slot is used, the next free slot while it is not.
+    uint16_t index;
+} SlotMapSlot;
+
+typedef struct
+{
+    uint16_t capacity;
+    // The free slots are a list through their `index`, the last one freed first. SLOT_MAP_NONE when all are used.
+    uint16_t free;
+} SlotMap;
+
+// `capacity` must be below SLOT_MAP_NONE.
+void slot_map_init(SlotMap *, SlotMapSlot *slots, size_t capacity);
+// Takes a slot for the item the caller is about to place at `index` of its dense array, and returns its handle, or
+// HANDLE_NONE when every slot is used. `owners[i]` is the slot of dense item i.
+Handle slot_map_insert(SlotMap *, SlotMapSlot *slots, uint16_t *owners, size_t index);
+// Where the item of `handle` is in the dense array now, or false when it was removed.
+bool slot_map_find(const SlotMap *, const SlotMapSlot *slots, Handle handle, size_t *index);
+Handle slot_map_handle(const SlotMapSlot *slots, const uint16_t *owners, size_t index);
+// Frees the slot of the item at `index`, as the caller moves its `last` item into that place. Items that never move,
+// like formation slots, pass their own index as `last`.
+void slot_map_remove(SlotMap *, SlotMapSlot *slots, uint16_t *owners, size_t index, size_t last);
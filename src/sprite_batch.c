@@ -0,0 +1,82 @@
+#include "sprite_batch.h"
+#include "rlgl.h"
+
+#include "assert.h"
+
+_Static_assert(SPRITE_BATCH_QUADS_PER_DRAW == RL_DEFAULT_BATCH_BUFFER_ELEMENTS, "the size of rlgl's own buffer");
+_Static_assert(RENDER_LIST_CAPACITY <= SPRITE_BATCH_QUADS_PER_DRAW, "a frame of sprites fits rlgl's buffer");
+
+void sprite_uvs_init(SpriteUvs *uvs, int texture_width, int texture_height)
+{
+    for (size_t id = 0; id < ATLAS_COUNT; ++id)
+    {
+        const AtlasDefinition *atlas = atlas_definition(id);
+        assert(atlas->pieces_count <= SPRITE_MAX_PIECES);
+        for (size_t i = 0; i < atlas->pieces_count; ++i)
+        {
+            float x = atlas->pieces[i].x * atlas->width + atlas->offset_width;
+            float y = atlas->pieces[i].y * atlas->height + atlas->offset_height;
+            uvs->pieces[id][i] = (SpriteUv){
+                .u0 = x / texture_width,
+                .v0 = y / texture_height,
+                .u1 = (x + atlas->width) / texture_width,
+                .v1 = (y + atlas->height) / texture_height,
+            };
+        }
+    }
+}
+
+void sprite_batch_build(SpriteBatch *batch, const SpriteUvs *uvs, const RenderList *list)
+{
+    for (size_t i = 0; i < list->count; ++i)
+    {
+        const RenderCommand *command = &list->items[i];
+        float x0 = command->destination.x;
+        float y0 = command->destination.y;
+        float x1 = x0 + command->destination.width;
+        float y1 = y0 + command->destination.height;
+        SpriteUv uv = uvs->pieces[command->atlas][command->frame];
+
+        // Counter clockwise from the top left, the order rlgl draws quads in.
+        SpriteVertex *vertex = &batch->vertices[4 * i];
+        vertex[0] = (SpriteVertex){x0, y0, uv.u0, uv.v0, command->tint};
+        vertex[1] = (SpriteVertex){x0, y1, uv.u0, uv.v1, command->tint};
+        vertex[2] = (SpriteVertex){x1, y1, uv.u1, uv.v1, command->tint};
+        vertex[3] = (SpriteVertex){x1, y0, uv.u1, uv.v0, command->tint};
+    }
+    batch->count = 4 * list->count;
+}
+
+SpriteBatchStats sprite_batch_stats(const SpriteBatch *batch)
+{
+    return (SpriteBatchStats){
+        .sprites = batch->count / 4,
+        .vertices = batch->count,
+    };
+}
+
+void sprite_batch_flush(SpriteBatch *batch, Texture2D texture)
+{
+    batch->stats = sprite_batch_stats(batch);
+    if (batch->count == 0)
+    {
+        return;
+    }
+
+    // One draw entry for the whole stream. rlgl draws by itself whenever its vertex buffer fills up, and draws the rest
+    // with whatever follows at the end of the frame or texture mode, so nothing is forced out here.
+    rlSetTexture(texture.id);
+    rlBegin(RL_QUADS);
+    rlNormal3f(0.0f, 0.0f, 1.0f);
+    for (size_t i = 0; i < batch->count; ++i)
+    {
+        Color color = batch->vertices[i].color;
+        rlColor4ub(color.r, color.g, color.b, color.a);
+        rlTexCoord2f(batch->vertices[i].u, batch->vertices[i].v);
+        rlVertex2f(batch->vertices[i].x, batch->vertices[i].y);
+    }
+    rlEnd();
+    rlSetTexture(0);
+
+    batch->count = 0;
+}
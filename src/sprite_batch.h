@@ -0,0 +1,57 @@
+#pragma once
+
+#include "game.h"
+#include "raylib.h"
+#include "render_list.h"
+#include "stddef.h"
+
+// Texture coordinates of every atlas piece, normalized to the sprite sheet. They only depend on the sheet's size, so
+// they are computed once when it is loaded instead of for every sprite.
+#define SPRITE_MAX_PIECES 4
+
+typedef struct
+{
+    float u0, v0, u1, v1;
+} SpriteUv;
+
+typedef struct
+{
+    SpriteUv pieces[ATLAS_COUNT][SPRITE_MAX_PIECES];
+} SpriteUvs;
+
+void sprite_uvs_init(SpriteUvs *, int texture_width, int texture_height);
+
+// A corner of a sprite's quad in screen space.
+typedef struct
+{
+    float x, y;
+    float u, v;
+    Color color;
+} SpriteVertex;
+
+// Quads rlgl's vertex buffer holds before it draws on its own. A whole render list fits, so rlgl never has to draw part
+// of a frame's sprites to make room for the rest.
+#define SPRITE_BATCH_QUADS_PER_DRAW 8192
+
+typedef struct
+{
+    size_t sprites;
+    size_t vertices;
+} SpriteBatchStats;
+
+// The raylib backend of render lists. Every command of a list becomes a quad in one vertex stream, four corners each.
+// Flushing submits the stream through rlgl with a single texture, so drawing a frame takes as few draw calls as rlgl's
+// buffer allows, whatever the number of sprites. rlgl draws them when its buffer fills or the frame ends.
+typedef struct
+{
+    SpriteVertex vertices[4 * RENDER_LIST_CAPACITY];
+    size_t count;
+    // What the last sprite_batch_flush() submitted.
+    SpriteBatchStats stats;
+} SpriteBatch;
+
+// Replaces the batch's vertices with the quads of `list`.
+void sprite_batch_build(SpriteBatch *, const SpriteUvs *uvs, const RenderList *list);
+// What flushing the batch as it is now would submit, without touching the GPU.
+SpriteBatchStats sprite_batch_stats(const SpriteBatch *);
+void sprite_batch_flush(SpriteBatch *, Texture2D texture);
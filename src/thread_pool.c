@@ -0,0 +1,254 @@
+#include "thread_pool.h"
+#include "assert.h"
+#include "stdlib.h"
+#include "unistd.h"
+
+static _Thread_local Worker *current_worker = NULL;
+
+static void deque_init(JobDeque *deque)
+{
+    pthread_mutex_init(&deque->lock, NULL);
+    deque->items = NULL;
+    deque->front = 0;
+    deque->count = 0;
+    deque->capacity = 0;
+}
+
+static void deque_free(JobDeque *deque)
+{
+    pthread_mutex_destroy(&deque->lock);
+    free(deque->items);
+}
+
+static void deque_push_back(JobDeque *deque, Job job)
+{
+    pthread_mutex_lock(&deque->lock);
+    if (deque->count == deque->capacity)
+    {
+        size_t capacity = deque->capacity == 0 ? 64 : deque->capacity * 2;
+        Job *items = malloc(capacity * sizeof(*items));
+        assert(items != NULL && "Buy more RAM lol");
+        for (size_t i = 0; i < deque->count; ++i)
+        {
+            items[i] = deque->items[(deque->front + i) % deque->capacity];
+        }
+        free(deque->items);
+        deque->items = items;
+        deque->front = 0;
+        deque->capacity = capacity;
+    }
+    deque->items[(deque->front + deque->count) % deque->capacity] = job;
+    deque->count += 1;
+    pthread_mutex_unlock(&deque->lock);
+}
+
+static bool deque_pop_back(JobDeque *deque, Job *job)
+{
+    bool found = false;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->count > 0)
+    {
+        deque->count -= 1;
+        *job = deque->items[(deque->front + deque->count) % deque->capacity];
+        found = true;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+static bool deque_pop_front(JobDeque *deque, Job *job)
+{
+    bool found = false;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->count > 0)
+    {
+        *job = deque->items[deque->front];
+        deque->front = (deque->front + 1) % deque->capacity;
+        deque->count -= 1;
+        found = true;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+// Own deque first (newest job, still warm in cache), then the oldest job of every other worker.
+static bool take_job(ThreadPool *pool, Worker *self, Job *job)
+{
+    if (atomic_load(&pool->queued) == 0)
+    {
+        return false;
+    }
+
+    size_t start = 0;
+    if (self != NULL)
+    {
+        if (deque_pop_back(&self->deque, job))
+        {
+            atomic_fetch_sub(&pool->queued, 1);
+            return true;
+        }
+        start = self->index + 1;
+    }
+
+    for (size_t i = 0; i < pool->workers_count; ++i)
+    {
+        Worker *victim = &pool->workers[(start + i) % pool->workers_count];
+        if (victim != self && deque_pop_front(&victim->deque, job))
+        {
+            atomic_fetch_sub(&pool->queued, 1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void run_job(ThreadPool *pool, Job job)
+{
+    job.function(job.data);
+
+    if (atomic_fetch_sub(&pool->pending, 1) == 1)
+    {
+        pthread_mutex_lock(&pool->lock);
+        pthread_cond_broadcast(&pool->wake);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+static void *worker_main(void *data)
+{
+    Worker *self = data;
+    ThreadPool *pool = self->pool;
+    current_worker = self;
+
+    while (true)
+    {
+        Job job;
+        if (take_job(pool, self, &job))
+        {
+            run_job(pool, job);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        while (!atomic_load(&pool->stopping) && atomic_load(&pool->queued) == 0)
+        {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        bool stopping = atomic_load(&pool->stopping);
+        pthread_mutex_unlock(&pool->lock);
+
+        if (stopping)
+        {
+            return NULL;
+        }
+    }
+}
+
+size_t thread_pool_cpu_count(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t)count : 1;
+}
+
+bool thread_pool_init(ThreadPool *pool, size_t workers_count)
+{
+    if (workers_count == 0)
+    {
+        workers_count = thread_pool_cpu_count();
+    }
+
+    pool->workers = calloc(workers_count, sizeof(*pool->workers));
+    if (pool->workers == NULL)
+    {
+        return false;
+    }
+    pool->workers_count = workers_count;
+    atomic_init(&pool->queued, 0);
+    atomic_init(&pool->pending, 0);
+    atomic_init(&pool->next_worker, 0);
+    atomic_init(&pool->stopping, false);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+
+    for (size_t i = 0; i < workers_count; ++i)
+    {
+        pool->workers[i].pool = pool;
+        pool->workers[i].index = i;
+        deque_init(&pool->workers[i].deque);
+    }
+
+    for (size_t i = 0; i < workers_count; ++i)
+    {
+        if (pthread_create(&pool->workers[i].thread, NULL, worker_main, &pool->workers[i]) != 0)
+        {
+            pool->workers_count = i;
+            thread_pool_destroy(pool);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void thread_pool_submit(ThreadPool *pool, JobFunction function, void *data)
+{
+    Worker *target = current_worker;
+    if (target == NULL || target->pool != pool)
+    {
+        target = &pool->workers[atomic_fetch_add(&pool->next_worker, 1) % pool->workers_count];
+    }
+
+    atomic_fetch_add(&pool->pending, 1);
+    atomic_fetch_add(&pool->queued, 1);
+    deque_push_back(&target->deque, (Job){.function = function, .data = data});
+
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void thread_pool_wait(ThreadPool *pool)
+{
+    Worker *self = current_worker != NULL && current_worker->pool == pool ? current_worker : NULL;
+
+    while (atomic_load(&pool->pending) > 0)
+    {
+        Job job;
+        if (take_job(pool, self, &job))
+        {
+            run_job(pool, job);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        while (atomic_load(&pool->pending) > 0 && atomic_load(&pool->queued) == 0)
+        {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+void thread_pool_destroy(ThreadPool *pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    atomic_store(&pool->stopping, true);
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < pool->workers_count; ++i)
+    {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+
+    for (size_t i = 0; i < pool->workers_count; ++i)
+    {
+        deque_free(&pool->workers[i].deque);
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->wake);
+    free(pool->workers);
+    *pool = (ThreadPool){0};
+}
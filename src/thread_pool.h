@@ -0,0 +1,59 @@
+#pragma once
+
+#include "pthread.h"
+#include "stdatomic.h"
+#include "stdbool.h"
+#include "stddef.h"
+
+typedef void (*JobFunction)(void *data);
+
+typedef struct
+{
+    JobFunction function;
+    void *data;
+} Job;
+
+// Double ended queue owned by one worker. The owner pushes and pops at the back, thieves take from the front.
+typedef struct
+{
+    pthread_mutex_t lock;
+    Job *items;
+    size_t front;
+    size_t count;
+    size_t capacity;
+} JobDeque;
+
+typedef struct ThreadPool ThreadPool;
+
+typedef struct
+{
+    ThreadPool *pool;
+    size_t index;
+    JobDeque deque;
+    pthread_t thread;
+} Worker;
+
+struct ThreadPool
+{
+    Worker *workers;
+    size_t workers_count;
+
+    // Jobs sitting in a deque, and jobs submitted but not finished yet.
+    atomic_size_t queued;
+    atomic_size_t pending;
+    atomic_size_t next_worker;
+    atomic_bool stopping;
+
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+};
+
+// Starts `workers_count` threads, or one per online CPU when it is 0.
+bool thread_pool_init(ThreadPool *, size_t workers_count);
+// Jobs submitted from a worker go to its own deque so related work stays on one core until someone steals it.
+void thread_pool_submit(ThreadPool *, JobFunction function, void *data);
+// Blocks until every submitted job has finished, running queued jobs on the calling thread meanwhile.
+void thread_pool_wait(ThreadPool *);
+void thread_pool_destroy(ThreadPool *);
+
+size_t thread_pool_cpu_count(void);
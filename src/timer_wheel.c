@@ -0,0 +1,125 @@
+#include "timer_wheel.h"
+
+#define DUE_LIST (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS)
+
+static void link_timer(TimerWheel *wheel, TimerNode *nodes, uint16_t id, uint16_t list)
+{
+    TimerNode *node = &nodes[id];
+    node->list = list;
+    node->prev = TIMER_NONE;
+    node->next = wheel->heads[list];
+    if (node->next != TIMER_NONE)
+    {
+        nodes[node->next].prev = id;
+    }
+    wheel->heads[list] = id;
+}
+
+static void unlink_timer(TimerWheel *wheel, TimerNode *nodes, uint16_t id)
+{
+    TimerNode *node = &nodes[id];
+    if (node->prev != TIMER_NONE)
+    {
+        nodes[node->prev].next = node->next;
+    }
+    else
+    {
+        wheel->heads[node->list] = node->next;
+    }
+    if (node->next != TIMER_NONE)
+    {
+        nodes[node->next].prev = node->prev;
+    }
+    node->list = TIMER_NONE;
+}
+
+// The lowest level whose blocks hold both now and `due`, in the slot of `due` on it. Timers beyond the top level wait in
+// its slots and are placed again each time the wheel passes them.
+static uint16_t list_for(const TimerWheel *wheel, uint32_t due)
+{
+    size_t level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 && ((due ^ wheel->now) >> (TIMER_WHEEL_SLOT_BITS * (level + 1))) != 0)
+    {
+        level += 1;
+    }
+    return level * TIMER_WHEEL_SLOTS + ((due >> (TIMER_WHEEL_SLOT_BITS * level)) & (TIMER_WHEEL_SLOTS - 1));
+}
+
+// Takes a whole list off first, so timers placed back into the same list are not visited twice.
+static void move_list(TimerWheel *wheel, TimerNode *nodes, uint16_t from, bool to_due)
+{
+    uint16_t id = wheel->heads[from];
+    wheel->heads[from] = TIMER_NONE;
+    while (id != TIMER_NONE)
+    {
+        uint16_t next = nodes[id].next;
+        link_timer(wheel, nodes, id, to_due ? DUE_LIST : list_for(wheel, nodes[id].due));
+        id = next;
+    }
+}
+
+void timer_wheel_init(TimerWheel *wheel, TimerNode *nodes, size_t count)
+{
+    wheel->now = 0;
+    for (size_t i = 0; i < TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS + 1; ++i)
+    {
+        wheel->heads[i] = TIMER_NONE;
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        nodes[i] = (TimerNode){.next = TIMER_NONE, .prev = TIMER_NONE, .list = TIMER_NONE};
+    }
+}
+
+void timer_wheel_schedule(TimerWheel *wheel, TimerNode *nodes, uint16_t id, uint32_t due, uint8_t tag)
+{
+    timer_wheel_cancel(wheel, nodes, id);
+    if ((int32_t)(due - wheel->now) <= 0)
+    {
+        due = wheel->now + 1;
+    }
+    nodes[id].due = due;
+    nodes[id].tag = tag;
+    link_timer(wheel, nodes, id, list_for(wheel, due));
+}
+
+void timer_wheel_cancel(TimerWheel *wheel, TimerNode *nodes, uint16_t id)
+{
+    if (nodes[id].list != TIMER_NONE)
+    {
+        unlink_timer(wheel, nodes, id);
+    }
+}
+
+bool timer_wheel_scheduled(const TimerNode *nodes, uint16_t id)
+{
+    return nodes[id].list != TIMER_NONE;
+}
+
+void timer_wheel_advance(TimerWheel *wheel, TimerNode *nodes)
+{
+    wheel->now += 1;
+
+    // Top down, so timers that come down from one level are already in place when the level below is redistributed.
+    for (size_t level = TIMER_WHEEL_LEVELS - 1; level > 0; --level)
+    {
+        uint32_t shift = TIMER_WHEEL_SLOT_BITS * level;
+        if ((wheel->now & ((1u << shift) - 1)) == 0)
+        {
+            move_list(wheel, nodes, level * TIMER_WHEEL_SLOTS + ((wheel->now >> shift) & (TIMER_WHEEL_SLOTS - 1)),
+                      false);
+        }
+    }
+
+    move_list(wheel, nodes, wheel->now & (TIMER_WHEEL_SLOTS - 1), true);
+}
+
+uint16_t timer_wheel_pop(TimerWheel *wheel, TimerNode *nodes)
+{
+    uint16_t id = wheel->heads[DUE_LIST];
+    if (id != TIMER_NONE)
+    {
+        unlink_timer(wheel, nodes, id);
+    }
+    return id;
+}
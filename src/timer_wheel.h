@@ -0,0 +1,46 @@
+#pragma once
+
+#include "stdbool.h"
+#include "stddef.h"
+#include "stdint.h"
+
+// Hierarchical timing wheel. A timer due within the current block of 64 ticks sits in the slot of its tick on level 0,
+// later ones sit in the slots of coarser levels of 64, 64^2 and 64^3 ticks and move down a level whenever the wheel
+// enters their slot. Advancing a tick touches one slot, plus one slot per level crossed, so the cost follows the timers
+// that fire rather than the timers held.
+//
+// Timers are nodes in an array owned by the caller, a timer's id is its index there. Links are indices, so a wheel and
+// its nodes are plain data that can live in State and be copied.
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_WHEEL_SLOT_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_NONE UINT16_MAX
+
+typedef struct
+{
+    uint32_t due;
+    uint16_t next;
+    uint16_t prev;
+    // The list the timer is linked into, TIMER_NONE when it is not scheduled.
+    uint16_t list;
+    // What the owner should do when it fires.
+    uint8_t tag;
+} TimerNode;
+
+typedef struct
+{
+    uint32_t now;
+    // A list per slot of every level, then the timers due on the current tick that were not popped yet.
+    uint16_t heads[TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS + 1];
+} TimerWheel;
+
+void timer_wheel_init(TimerWheel *, TimerNode *nodes, size_t count);
+// Schedules timer `id` for tick `due`, replacing its previous schedule. A tick that is not in the future fires on the
+// next one.
+void timer_wheel_schedule(TimerWheel *, TimerNode *nodes, uint16_t id, uint32_t due, uint8_t tag);
+void timer_wheel_cancel(TimerWheel *, TimerNode *nodes, uint16_t id);
+bool timer_wheel_scheduled(const TimerNode *nodes, uint16_t id);
+// Moves to the next tick, after which timer_wheel_pop() returns the timers due on it.
+void timer_wheel_advance(TimerWheel *, TimerNode *nodes);
+// Unschedules and returns a timer due on the current tick, or TIMER_NONE when all of them were popped.
+uint16_t timer_wheel_pop(TimerWheel *, TimerNode *nodes);
@@ -0,0 +1,32 @@
+#include "triple_buffer.h"
+
+#define TRIPLE_BUFFER_FRESH 4u
+
+void triple_buffer_init(TripleBuffer *buffer)
+{
+    buffer->front = 0;
+    atomic_init(&buffer->middle, 1);
+    buffer->back = 2;
+}
+
+size_t triple_buffer_back(const TripleBuffer *buffer)
+{
+    return buffer->back;
+}
+
+void triple_buffer_publish(TripleBuffer *buffer)
+{
+    // Release so the reader sees the value written into the slot, acquire so the slot handed back is done being read.
+    unsigned fresh = buffer->back | TRIPLE_BUFFER_FRESH;
+    buffer->back = atomic_exchange_explicit(&buffer->middle, fresh, memory_order_acq_rel) & ~TRIPLE_BUFFER_FRESH;
+}
+
+size_t triple_buffer_front(TripleBuffer *buffer)
+{
+    if (atomic_load_explicit(&buffer->middle, memory_order_relaxed) & TRIPLE_BUFFER_FRESH)
+    {
+        buffer->front =
+            atomic_exchange_explicit(&buffer->middle, buffer->front, memory_order_acq_rel) & ~TRIPLE_BUFFER_FRESH;
+    }
+    return buffer->front;
+}
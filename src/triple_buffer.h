@@ -0,0 +1,27 @@
+#pragma once
+
+#include "stdatomic.h"
+#include "stdbool.h"
+#include "stddef.h"
+
+// Hands the newest of a stream of values from one writer thread to one reader thread without locks. The caller owns
+// TRIPLE_BUFFER_SLOTS values and both sides only ever touch the slot whose index they hold: the writer fills its back
+// slot and swaps it with the middle one, the reader swaps its front slot with the middle one when that is fresher.
+// Neither side waits for the other, and the reader always has a whole value, the newest published when it looked.
+#define TRIPLE_BUFFER_SLOTS 3
+
+typedef struct
+{
+    // Index of the middle slot, with TRIPLE_BUFFER_FRESH set when the writer published it after the reader last looked.
+    atomic_uint middle;
+    unsigned back;
+    unsigned front;
+} TripleBuffer;
+
+void triple_buffer_init(TripleBuffer *);
+// The slot the writer fills next.
+size_t triple_buffer_back(const TripleBuffer *);
+// Makes the back slot the newest value and hands the writer another one.
+void triple_buffer_publish(TripleBuffer *);
+// The slot holding the newest published value, which stays the reader's until it calls this again.
+size_t triple_buffer_front(TripleBuffer *);